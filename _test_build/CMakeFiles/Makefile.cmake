@@ -0,0 +1,80 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/config.h.cmake"
+  "/root/repo/src/ebusd/CMakeLists.txt"
+  "/root/repo/src/lib/ebus/CMakeLists.txt"
+  "/root/repo/src/lib/ebus/contrib/CMakeLists.txt"
+  "/root/repo/src/lib/ebus/contrib/test/CMakeLists.txt"
+  "/root/repo/src/lib/ebus/test/CMakeLists.txt"
+  "/root/repo/src/lib/utils/CMakeLists.txt"
+  "/root/repo/src/tools/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceRuns.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckFunctionExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceRuns.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "config.h"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/ebusd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/lib/utils/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/lib/ebus/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/lib/ebus/contrib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/lib/ebus/contrib/test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/lib/ebus/test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/tools/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/ebusd/CMakeFiles/ebusd.dir/DependInfo.cmake"
+  "src/lib/utils/CMakeFiles/utils.dir/DependInfo.cmake"
+  "src/lib/ebus/CMakeFiles/ebus.dir/DependInfo.cmake"
+  "src/lib/ebus/contrib/CMakeFiles/ebuscontrib.dir/DependInfo.cmake"
+  "src/lib/ebus/contrib/test/CMakeFiles/test_tem.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_filereader.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_device.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_symbol.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_data.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_message.dir/DependInfo.cmake"
+  "src/lib/ebus/test/CMakeFiles/test_format.dir/DependInfo.cmake"
+  "src/tools/CMakeFiles/ebusctl.dir/DependInfo.cmake"
+  "src/tools/CMakeFiles/ebusfeed.dir/DependInfo.cmake"
+  )
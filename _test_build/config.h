@@ -0,0 +1,56 @@
+/* Defined if contributed sources are enabled. */
+#define HAVE_CONTRIB
+
+/* Defined if direct conversion from float to int is available (2 for swapped byte order). */
+#define HAVE_DIRECT_FLOAT_FORMAT 1
+
+/* Defined if MQTT handling is enabled. */
+/* #undef HAVE_MQTT */
+
+/* Defined if ppoll() is available. */
+#define HAVE_PPOLL
+
+/* Defined if pselect() is available. */
+#define HAVE_PSELECT
+
+/* Defined if pthread_setname_np is available. */
+#define HAVE_PTHREAD_SETNAME_NP
+
+/* The name of package. */
+#define PACKAGE "ebusd"
+
+/* The address where bug reports for this package should be sent. */
+#define PACKAGE_BUGREPORT "ebusd@ebusd.eu"
+
+/* The default path of the configuration files. */
+#define PACKAGE_CONFIGPATH SYSCONFDIR "/" PACKAGE
+
+/* The path and name of the log file. */
+#define PACKAGE_LOGFILE LOCALSTATEDIR "/log/" PACKAGE ".log"
+
+/* The full name of this package. */
+#define PACKAGE_NAME "ebusd"
+
+/* The path and name of the PID file. */
+#define PACKAGE_PIDFILE LOCALSTATEDIR "/run/" PACKAGE ".pid"
+
+/* The full name and version of this package. */
+#define PACKAGE_STRING "ebusd 3.0pre"
+
+/* The tra name of this package. */
+#define PACKAGE_TARNAME "ebusd"
+
+/* The home page for this package. */
+#define PACKAGE_URL "https://github.com/john30/ebusd"
+
+/* The version of this package. */
+#define PACKAGE_VERSION "3.0pre"
+
+/* The revision of the package. */
+#define REVISION "32f688e"
+
+/* The version of the package formatted for the scan result. */
+#define SCAN_VERSION "300"
+
+/* The version of the package. */
+#define VERSION "3.0pre"
@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ebusd/bushandler.cpp" "src/ebusd/CMakeFiles/ebusd.dir/bushandler.cpp.o" "gcc" "src/ebusd/CMakeFiles/ebusd.dir/bushandler.cpp.o.d"
+  "/root/repo/src/ebusd/datahandler.cpp" "src/ebusd/CMakeFiles/ebusd.dir/datahandler.cpp.o" "gcc" "src/ebusd/CMakeFiles/ebusd.dir/datahandler.cpp.o.d"
+  "/root/repo/src/ebusd/main.cpp" "src/ebusd/CMakeFiles/ebusd.dir/main.cpp.o" "gcc" "src/ebusd/CMakeFiles/ebusd.dir/main.cpp.o.d"
+  "/root/repo/src/ebusd/mainloop.cpp" "src/ebusd/CMakeFiles/ebusd.dir/mainloop.cpp.o" "gcc" "src/ebusd/CMakeFiles/ebusd.dir/mainloop.cpp.o.d"
+  "/root/repo/src/ebusd/network.cpp" "src/ebusd/CMakeFiles/ebusd.dir/network.cpp.o" "gcc" "src/ebusd/CMakeFiles/ebusd.dir/network.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_test_build/src/lib/utils/CMakeFiles/utils.dir/DependInfo.cmake"
+  "/root/repo/_test_build/src/lib/ebus/CMakeFiles/ebus.dir/DependInfo.cmake"
+  "/root/repo/_test_build/src/lib/ebus/contrib/CMakeFiles/ebuscontrib.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
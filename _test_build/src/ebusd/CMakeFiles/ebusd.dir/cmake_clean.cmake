@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ebusd.dir/bushandler.cpp.o"
+  "CMakeFiles/ebusd.dir/bushandler.cpp.o.d"
+  "CMakeFiles/ebusd.dir/datahandler.cpp.o"
+  "CMakeFiles/ebusd.dir/datahandler.cpp.o.d"
+  "CMakeFiles/ebusd.dir/main.cpp.o"
+  "CMakeFiles/ebusd.dir/main.cpp.o.d"
+  "CMakeFiles/ebusd.dir/mainloop.cpp.o"
+  "CMakeFiles/ebusd.dir/mainloop.cpp.o.d"
+  "CMakeFiles/ebusd.dir/network.cpp.o"
+  "CMakeFiles/ebusd.dir/network.cpp.o.d"
+  "ebusd"
+  "ebusd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ebusd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/lib/ebus/data.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/data.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/data.cpp.o.d"
+  "/root/repo/src/lib/ebus/datatype.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/datatype.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/datatype.cpp.o.d"
+  "/root/repo/src/lib/ebus/device.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/device.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/device.cpp.o.d"
+  "/root/repo/src/lib/ebus/filereader.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/filereader.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/filereader.cpp.o.d"
+  "/root/repo/src/lib/ebus/message.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/message.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/message.cpp.o.d"
+  "/root/repo/src/lib/ebus/result.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/result.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/result.cpp.o.d"
+  "/root/repo/src/lib/ebus/symbol.cpp" "src/lib/ebus/CMakeFiles/ebus.dir/symbol.cpp.o" "gcc" "src/lib/ebus/CMakeFiles/ebus.dir/symbol.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ebus.dir/data.cpp.o"
+  "CMakeFiles/ebus.dir/data.cpp.o.d"
+  "CMakeFiles/ebus.dir/datatype.cpp.o"
+  "CMakeFiles/ebus.dir/datatype.cpp.o.d"
+  "CMakeFiles/ebus.dir/device.cpp.o"
+  "CMakeFiles/ebus.dir/device.cpp.o.d"
+  "CMakeFiles/ebus.dir/filereader.cpp.o"
+  "CMakeFiles/ebus.dir/filereader.cpp.o.d"
+  "CMakeFiles/ebus.dir/message.cpp.o"
+  "CMakeFiles/ebus.dir/message.cpp.o.d"
+  "CMakeFiles/ebus.dir/result.cpp.o"
+  "CMakeFiles/ebus.dir/result.cpp.o.d"
+  "CMakeFiles/ebus.dir/symbol.cpp.o"
+  "CMakeFiles/ebus.dir/symbol.cpp.o.d"
+  "libebus.a"
+  "libebus.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ebus.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/lib/ebus
+# Build directory: /root/repo/_test_build/src/lib/ebus
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("contrib")
+subdirs("test")
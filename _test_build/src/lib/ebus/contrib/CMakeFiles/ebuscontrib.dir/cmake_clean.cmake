@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ebuscontrib.dir/contrib.cpp.o"
+  "CMakeFiles/ebuscontrib.dir/contrib.cpp.o.d"
+  "CMakeFiles/ebuscontrib.dir/tem.cpp.o"
+  "CMakeFiles/ebuscontrib.dir/tem.cpp.o.d"
+  "libebuscontrib.a"
+  "libebuscontrib.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ebuscontrib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_tem.dir/test_tem.cpp.o"
+  "CMakeFiles/test_tem.dir/test_tem.cpp.o.d"
+  "test_tem"
+  "test_tem.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_tem.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
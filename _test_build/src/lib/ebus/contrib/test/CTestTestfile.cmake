@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/lib/ebus/contrib/test
+# Build directory: /root/repo/_test_build/src/lib/ebus/contrib/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(tem "test_tem")
+set_tests_properties(tem PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/contrib/test/CMakeLists.txt;7;add_test;/root/repo/src/lib/ebus/contrib/test/CMakeLists.txt;0;")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_filereader.dir/test_filereader.cpp.o"
+  "CMakeFiles/test_filereader.dir/test_filereader.cpp.o.d"
+  "test_filereader"
+  "test_filereader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_filereader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_symbol.dir/test_symbol.cpp.o"
+  "CMakeFiles/test_symbol.dir/test_symbol.cpp.o.d"
+  "test_symbol"
+  "test_symbol.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_symbol.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,18 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/lib/ebus/test
+# Build directory: /root/repo/_test_build/src/lib/ebus/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(filereader "test_filereader")
+set_tests_properties(filereader PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;12;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
+add_test(device "test_device")
+set_tests_properties(device PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;16;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
+add_test(symbol "test_symbol")
+set_tests_properties(symbol PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;20;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
+add_test(data "test_data")
+set_tests_properties(data PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;24;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
+add_test(message "test_message")
+set_tests_properties(message PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;28;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
+add_test(format "test_format")
+set_tests_properties(format PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/lib/ebus/test/CMakeLists.txt;32;add_test;/root/repo/src/lib/ebus/test/CMakeLists.txt;0;")
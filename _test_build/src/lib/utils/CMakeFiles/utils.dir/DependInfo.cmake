@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/lib/utils/clock.cpp" "src/lib/utils/CMakeFiles/utils.dir/clock.cpp.o" "gcc" "src/lib/utils/CMakeFiles/utils.dir/clock.cpp.o.d"
+  "/root/repo/src/lib/utils/log.cpp" "src/lib/utils/CMakeFiles/utils.dir/log.cpp.o" "gcc" "src/lib/utils/CMakeFiles/utils.dir/log.cpp.o.d"
+  "/root/repo/src/lib/utils/rotatefile.cpp" "src/lib/utils/CMakeFiles/utils.dir/rotatefile.cpp.o" "gcc" "src/lib/utils/CMakeFiles/utils.dir/rotatefile.cpp.o.d"
+  "/root/repo/src/lib/utils/tcpsocket.cpp" "src/lib/utils/CMakeFiles/utils.dir/tcpsocket.cpp.o" "gcc" "src/lib/utils/CMakeFiles/utils.dir/tcpsocket.cpp.o.d"
+  "/root/repo/src/lib/utils/thread.cpp" "src/lib/utils/CMakeFiles/utils.dir/thread.cpp.o" "gcc" "src/lib/utils/CMakeFiles/utils.dir/thread.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/utils.dir/clock.cpp.o"
+  "CMakeFiles/utils.dir/clock.cpp.o.d"
+  "CMakeFiles/utils.dir/log.cpp.o"
+  "CMakeFiles/utils.dir/log.cpp.o.d"
+  "CMakeFiles/utils.dir/rotatefile.cpp.o"
+  "CMakeFiles/utils.dir/rotatefile.cpp.o.d"
+  "CMakeFiles/utils.dir/tcpsocket.cpp.o"
+  "CMakeFiles/utils.dir/tcpsocket.cpp.o.d"
+  "CMakeFiles/utils.dir/thread.cpp.o"
+  "CMakeFiles/utils.dir/thread.cpp.o.d"
+  "libutils.a"
+  "libutils.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/utils.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ebusctl.dir/ebusctl.cpp.o"
+  "CMakeFiles/ebusctl.dir/ebusctl.cpp.o.d"
+  "ebusctl"
+  "ebusctl.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ebusctl.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ebusfeed.dir/ebusfeed.cpp.o"
+  "CMakeFiles/ebusfeed.dir/ebusfeed.cpp.o.d"
+  "ebusfeed"
+  "ebusfeed.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ebusfeed.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
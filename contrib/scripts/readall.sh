@@ -11,12 +11,4 @@ if [ "x$1" = "x-R" ]; then
   readargs=$1
   shift
 fi
-for i in `echo "f -F circuit,name" "$@"|nc -q 1 127.0.0.1 $port|sort -u|egrep ','`; do
-  circuit=${i%%,*}
-  name=${i##*,}
-  if [ -z "$circuit" ] || [ -z "$name" ] || [ "$circuit,$name" = "scan,id" ]; then
-    continue
-  fi
-  ret=`echo "r ${readargs} -c $circuit $name" |nc -q 1 127.0.0.1 $port|head -n 1`
-  echo "$circuit $name = $ret"
-done
+ebusctl -p $port readall ${readargs} "$@"
@@ -63,6 +63,17 @@ const char* getStateCode(BusState state) {
   }
 }
 
+/**
+ * Return the index of the priority class of a master address.
+ * @param address the master address.
+ * @return the index of the priority class (0 to @a PRIORITY_CLASSES - 1, i.e. 0 for 0, 1 for 1, 2 for 3, 3 for 7,
+ * and 4 for F in the lower nibble).
+ */
+static size_t getPriorityClass(symbol_t address) {
+  unsigned int number = getMasterNumber(address);
+  return number == 0 ? 0 : (number - 1) / 5;
+}
+
 result_t PollRequest::prepare(symbol_t ownMasterAddress) {
   istringstream input;
   result_t result = m_message->prepareMaster(ownMasterAddress, m_master, input, UI_FIELD_SEPARATOR, SYN, m_index);
@@ -98,6 +109,75 @@ bool PollRequest::notify(result_t result, SlaveSymbolString& slave) {
 }
 
 
+bool MultiReadRequest::prepare(symbol_t ownMasterAddress) {
+  m_masterAddress = ownMasterAddress;
+  while (m_current < m_messages.size()) {
+    Message* message = m_messages[m_current];
+    istringstream input(m_inputStr);
+    result_t result = message->prepareMaster(ownMasterAddress, m_master, input, UI_FIELD_SEPARATOR, SYN, m_index);
+    if (result == RESULT_OK) {
+      logInfo(lf_bus, "%s cmd: %s", message->isWrite() ? "write" : "read", m_master.getStr().c_str());
+      return true;
+    }
+    logError(lf_bus, "prepare %s %s %s: %s", message->isWrite() ? "write" : "read", message->getCircuit().c_str(),
+        message->getName().c_str(), getResultCode(result));
+    finishCurrent(result);
+  }
+  return false;
+}
+
+bool MultiReadRequest::notify(result_t result, SlaveSymbolString& slave) {
+  Message* message = m_messages[m_current];
+  if (result == RESULT_OK) {
+    m_messageMap->invalidateCache(message);  // e.g. the read counterpart of a written message
+    result = message->storeLastData(slave, m_index);
+    if (result >= RESULT_OK && m_index+1 < message->getCount()) {
+      m_index++;
+      m_sendRetries = 0;
+      return prepare(m_masterAddress);
+    }
+  } else if (result != RESULT_ERR_NO_SIGNAL && result != RESULT_ERR_SEND && result != RESULT_ERR_DEVICE
+      && m_sendRetries < m_failedSendRetries) {
+    m_sendRetries++;
+    logError(lf_bus, "read %s %s: %s, retry", message->getCircuit().c_str(), message->getName().c_str(),
+        getResultCode(result));
+    return true;
+  }
+  if (result < RESULT_OK) {
+    logError(lf_bus, "read %s %s: %s", message->getCircuit().c_str(), message->getName().c_str(),
+        getResultCode(result));
+  }
+  finishCurrent(result);
+  if (result == RESULT_ERR_NO_SIGNAL || result == RESULT_ERR_DEVICE) {
+    while (m_current < m_messages.size()) {  // no need to try the remaining ones
+      finishCurrent(result);
+    }
+    return false;
+  }
+  return prepare(m_masterAddress);
+}
+
+Message* MultiReadRequest::waitForNext(result_t* result) {
+  if (m_waited >= m_messages.size()) {
+    return NULL;
+  }
+  Message* message;
+  while ((message = m_finished.pop(1)) == NULL) {
+    // wait until the next one is finished (the BusHandler notifies each request at the latest when losing signal)
+  }
+  *result = m_results[m_waited++];
+  return message;
+}
+
+void MultiReadRequest::finishCurrent(result_t result) {
+  m_results[m_current] = result;
+  Message* message = m_messages[m_current++];
+  m_index = 0;
+  m_sendRetries = 0;
+  m_finished.push(message);
+}
+
+
 result_t ScanRequest::prepare(symbol_t ownMasterAddress) {
   if (m_slaves.empty()) {
     return RESULT_ERR_EOF;
@@ -327,11 +407,13 @@ result_t BusHandler::sendAndWait(MasterSymbolString& master, SlaveSymbolString&
   slave.clear();
   ActiveBusRequest request(master, slave);
   logInfo(lf_bus, "send message: %s", master.getStr().c_str());
+  uint64_t start = clockGetMicros();
 
   for (int sendRetries = m_failedSendRetries + 1; sendRetries >= 0; sendRetries--) {
-    m_nextRequests.push(&request);
-    bool success = m_finishedRequests.remove(&request, true);
-    result = success ? request.m_result : RESULT_ERR_TIMEOUT;
+    request.m_finished = false;
+    queueRequest(&request);
+    request.waitForFinish();
+    result = request.m_result;
     if (result == RESULT_OK) {
       Message* message = m_messages->find(master);
       if (message != NULL) {
@@ -339,13 +421,14 @@ result_t BusHandler::sendAndWait(MasterSymbolString& master, SlaveSymbolString&
       }
       break;
     }
-    if (!success || result == RESULT_ERR_NO_SIGNAL || result == RESULT_ERR_SEND || result == RESULT_ERR_DEVICE) {
+    if (result == RESULT_ERR_NO_SIGNAL || result == RESULT_ERR_SEND || result == RESULT_ERR_DEVICE) {
       logError(lf_bus, "send to %2.2x: %s, give up", master[1], getResultCode(result));
       break;
     }
     logError(lf_bus, "send to %2.2x: %s%s", master[1], getResultCode(result), sendRetries > 0 ? ", retry" : "");
     request.m_busLostRetries = 0;
   }
+  m_sendStats.addSince(start);
   return result;
 }
 
@@ -377,6 +460,23 @@ result_t BusHandler::readFromBus(Message* message, string inputStr, const symbol
   return ret;
 }
 
+MultiReadRequest* BusHandler::startRead(const deque<Message*>& messages, BusRequestListener* listener,
+    const string& inputStr) {
+  MultiReadRequest* request = new MultiReadRequest(m_messages, messages, m_failedSendRetries, inputStr);
+  request->setListener(listener);
+  if (request->prepare(m_ownMasterAddress)) {
+    queueRequest(request);
+  } else {
+    request->setFinished();  // nothing to send at all
+  }
+  return listener ? NULL : request;
+}
+
+void BusHandler::finishRead(MultiReadRequest* request) {
+  request->waitForFinish();
+  delete request;
+}
+
 void BusHandler::run() {
   unsigned int symCount = 0;
   time_t now, lastTime;
@@ -399,6 +499,7 @@ void BusHandler::run() {
             logNotice(lf_bus, "max. symbols per second: %d", m_maxSymPerSec);
           }
         }
+        updateBusLoad((unsigned int)(now-lastTime));
         lastTime = now;
         symCount = 0;
       }
@@ -415,10 +516,38 @@ void BusHandler::run() {
         setState(bs_noSignal, result);
       }
       symCount = 0;
+      m_payloadSymbolCount = m_synSymbolCount = m_periodContentionCount = 0;
       time(&lastTime);
       lastTime += 2;
     }
   } while (isRunning());
+  // notify the current and all queued requests so that nobody keeps waiting for the stopped bus
+  m_state = bs_noSignal;  // no need to report a lost signal
+  setState(bs_noSignal, RESULT_ERR_NO_SIGNAL);
+}
+
+void BusHandler::updateBusLoad(unsigned int seconds) {
+  m_payloadSymPerSec = m_payloadSymbolCount / seconds;
+  m_synSymPerSec = m_synSymbolCount / seconds;
+  // each contention event occupies the bus for about one more telegram, so that only frequent contention counts
+  unsigned int load = (m_payloadSymbolCount + m_periodContentionCount * CONTENTION_SYMBOLS) * 100
+      / (SYMBOLS_PER_SECOND * seconds);
+  if (load > 100) {
+    load = 100;
+  }
+  // moving average with a weight of 1/4 for the period just passed
+  m_busLoad = (3 * m_busLoad + load + 2) / 4;
+  bool congested = m_busLoadLimit > 0 && m_busLoad > m_busLoadLimit;
+  if (congested != m_busCongested) {
+    m_busCongested = congested;
+    if (congested) {
+      logInfo(lf_bus, "bus load %d%%, %d contention events: delaying polls and scans", m_busLoad,
+          m_periodContentionCount);
+    } else {
+      logInfo(lf_bus, "bus load %d%%: resuming polls and scans", m_busLoad);
+    }
+  }
+  m_payloadSymbolCount = m_synSymbolCount = m_periodContentionCount = 0;
 }
 
 result_t BusHandler::handleSymbol() {
@@ -442,21 +571,33 @@ result_t BusHandler::handleSymbol() {
       setState(bs_ready, RESULT_ERR_TIMEOUT);  // just to be sure an old BusRequest is cleaned up
     } else if (m_remainLockCount == 0) {
       startRequest = m_nextRequests.peek();
+      if (m_busCongested) {
+        // let user requests pass while polls and scans have to wait
+        while (startRequest != NULL && startRequest->isDeferrable()) {
+          startRequest = m_nextRequests.peekNext(startRequest);
+        }
+      }
       if (startRequest == NULL && m_pollInterval > 0) {  // check for poll/scan
         time_t now;
         time(&now);
-        if (m_lastPoll == 0 || difftime(now, m_lastPoll) > m_pollInterval) {
-          Message* message = m_messages->getNextPoll();
+        if (!m_pollRequestActive && (m_lastPoll == 0 || difftime(now, m_lastPoll) > m_pollInterval)) {
+          Message* message = NULL;
+          if (m_busCongested) {
+            m_lastPoll = now;  // skip this poll cycle
+            m_delayedPollCount++;
+          } else {
+            message = m_messages->getNextPoll();
+          }
           if (message != NULL) {
             m_lastPoll = now;
-            PollRequest* request = new PollRequest(message);
-            result_t ret = request->prepare(m_ownMasterAddress);
+            m_pollRequest.reset(message);
+            result_t ret = m_pollRequest.prepare(m_ownMasterAddress);
             if (ret != RESULT_OK) {
               logError(lf_bus, "prepare poll message: %s", getResultCode(ret));
-              delete request;
             } else {
-              startRequest = request;
-              m_nextRequests.push(request);
+              m_pollRequestActive = true;
+              startRequest = &m_pollRequest;
+              queueRequest(&m_pollRequest);
             }
           }
         }
@@ -602,6 +743,9 @@ result_t BusHandler::handleSymbol() {
     if (sending && startRequest != NULL && m_nextRequests.remove(startRequest)) {
       m_currentRequest = startRequest;  // force the failed request to be notified
     }
+    if (result == RESULT_ERR_TIMEOUT) {
+      countMissingAnswer();
+    }
     if ((m_generateSynInterval != SYN_TIMEOUT && difftime(now, m_lastReceive) > 1)
       // at least one full second has passed since last received symbol
       || m_state == bs_noSignal) {
@@ -611,7 +755,21 @@ result_t BusHandler::handleSymbol() {
   }
 
   m_lastReceive = now;
+  uint64_t symbolTime = clockGetMicros();
+  uint64_t symbolGap = m_lastSymbolTime > 0 && symbolTime > m_lastSymbolTime ? symbolTime - m_lastSymbolTime : 0;
+  if (recvSymbol != SYN) {
+    m_payloadSymbolCount++;
+    m_symbolGapStats.add(symbolGap);
+  } else {
+    m_synSymbolCount++;
+    if (m_lastSymbolSyn) {
+      m_synIntervalStats.add(symbolGap);
+    }
+  }
+  m_lastSymbolTime = symbolTime;
+  m_lastSymbolSyn = recvSymbol == SYN;
   if ((recvSymbol == SYN) && (m_state != bs_sendSyn)) {
+    countMissingAnswer();
     if (!sending && m_remainLockCount > 0 && m_command.size() != 1) {
       m_remainLockCount--;
     } else if (!sending && m_remainLockCount == 0 && m_command.size() == 1) {
@@ -620,18 +778,6 @@ result_t BusHandler::handleSymbol() {
     return setState(bs_ready, m_state == bs_skip ? RESULT_OK : RESULT_ERR_SYN);
   }
 
-  switch (m_state) {
-  case bs_ready:
-  case bs_recvCmd:
-  case bs_recvRes:
-  case bs_sendCmd:
-  case bs_sendRes:
-    SymbolString::updateCrc(m_crc, recvSymbol);
-    break;
-  default:
-    break;
-  }
-
   if (m_escape) {
     // check escape/unescape state
     if (sending) {
@@ -668,13 +814,19 @@ result_t BusHandler::handleSymbol() {
         return setState(bs_skip, RESULT_ERR_TIMEOUT);
       }
       m_currentRequest = startRequest;
+      m_queueWaitStats.add(m_lastSymbolTime > startRequest->m_queueTime
+          ? m_lastSymbolTime - startRequest->m_queueTime : 0);
       // check arbitration
+      size_t priorityClass = getPriorityClass(sendSymbol);
       if (recvSymbol == sendSymbol) {  // arbitration successful
+        m_arbitrationWonCounts[priorityClass]++;
         m_nextSendPos = 1;
         m_repeat = false;
         return setState(bs_sendCmd, RESULT_OK);
       }
       // arbitration lost. if same priority class found, try again after next AUTO-SYN
+      m_arbitrationLostCount++;
+      m_arbitrationLostCounts[priorityClass]++;
       m_remainLockCount = isMaster(recvSymbol) ? 2 : 1;  // number of SYN to wait for before next send try
       if ((recvSymbol & 0x0f) != (sendSymbol & 0x0f) && m_lockCount > m_remainLockCount) {
         // if different priority class found, try again after N AUTO-SYN symbols (at least next AUTO-SYN)
@@ -689,12 +841,14 @@ result_t BusHandler::handleSymbol() {
   case bs_recvCmd:
     m_command.push_back(recvSymbol);
     if (m_command.isComplete()) {  // all data received
+      m_crc = m_command.calcCrc();
       return setState(bs_recvCmdCrc, RESULT_OK);
     }
     return RESULT_OK;
 
   case bs_recvCmdCrc:
     m_crcValid = recvSymbol == m_crc;
+    countCommand(m_command, m_crcValid, now);
     if (m_command[1] == BROADCAST) {
       if (m_crcValid) {
         receiveCompleted();
@@ -723,6 +877,16 @@ result_t BusHandler::handleSymbol() {
     return setState(bs_recvCmdAck, RESULT_ERR_CRC);
 
   case bs_recvCmdAck:
+    if (recvSymbol == ACK || recvSymbol == NAK) {
+      MasterSymbolString& command = getCurrentCommand();
+      m_responseStats[command[1]].add(symbolGap);
+      AddressTraffic& traffic = m_traffic[command[1]];
+      AddressTraffic::add(traffic.m_byteCount);
+      traffic.m_lastSeen.store(now, std::memory_order_relaxed);
+      if (recvSymbol == NAK) {
+        AddressTraffic::add(m_traffic[command[0]].m_nakCount);
+      }
+    }
     if (recvSymbol == ACK) {
       if (!m_crcValid) {
         return setState(bs_skip, RESULT_ERR_ACK);
@@ -742,7 +906,6 @@ result_t BusHandler::handleSymbol() {
     if (recvSymbol == NAK) {
       if (!m_repeat) {
         m_repeat = true;
-        m_crc = 0;
         m_nextSendPos = 0;
         m_command.clear();
         if (m_currentRequest != NULL) {
@@ -757,12 +920,21 @@ result_t BusHandler::handleSymbol() {
   case bs_recvRes:
     m_response.push_back(recvSymbol);
     if (m_response.isComplete()) {  // all data received
+      m_crc = m_response.calcCrc();
       return setState(bs_recvResCrc, RESULT_OK);
     }
     return RESULT_OK;
 
   case bs_recvResCrc:
     m_crcValid = recvSymbol == m_crc;
+    {
+      AddressTraffic& traffic = m_traffic[getCurrentCommand()[1]];
+      AddressTraffic::add(traffic.m_byteCount, static_cast<unsigned int>(m_response.size() + 1));
+      traffic.m_lastSeen.store(now, std::memory_order_relaxed);
+      if (!m_crcValid) {
+        AddressTraffic::add(traffic.m_crcErrorCount);
+      }
+    }
     if (m_crcValid) {
       if (m_currentRequest != NULL) {
         return setState(bs_sendResAck, RESULT_OK);
@@ -781,6 +953,14 @@ result_t BusHandler::handleSymbol() {
     return setState(bs_recvResAck, RESULT_ERR_CRC);
 
   case bs_recvResAck:
+    if (recvSymbol == ACK || recvSymbol == NAK) {
+      MasterSymbolString& command = getCurrentCommand();
+      AddressTraffic::add(m_traffic[command[0]].m_byteCount);
+      m_traffic[command[0]].m_lastSeen.store(now, std::memory_order_relaxed);
+      if (recvSymbol == NAK) {
+        AddressTraffic::add(m_traffic[command[1]].m_nakCount);
+      }
+    }
     if (recvSymbol == ACK) {
       if (!m_crcValid) {
         return setState(bs_skip, RESULT_ERR_ACK);
@@ -813,11 +993,13 @@ result_t BusHandler::handleSymbol() {
     }
     m_nextSendPos++;
     if (m_nextSendPos >= m_currentRequest->m_master.size()) {
+      m_crc = m_currentRequest->m_master.calcCrc();
       return setState(bs_sendCmdCrc, RESULT_OK);
     }
     return RESULT_OK;
 
   case bs_sendCmdCrc:
+    countCommand(m_currentRequest->m_master, true, now);
     if (m_currentRequest->m_master[1] == BROADCAST) {
       return setState(bs_sendSyn, RESULT_OK);
     }
@@ -831,7 +1013,9 @@ result_t BusHandler::handleSymbol() {
     if (recvSymbol != sendSymbol) {
       return setState(bs_skip, RESULT_ERR_SYMBOL);
     }
+    AddressTraffic::add(m_traffic[m_currentRequest->m_master[0]].m_byteCount);
     if (!m_crcValid) {
+      AddressTraffic::add(m_traffic[m_currentRequest->m_master[1]].m_nakCount);
       if (!m_repeat) {
         m_repeat = true;
         m_response.clear();
@@ -851,7 +1035,6 @@ result_t BusHandler::handleSymbol() {
     if (!m_crcValid) {
       if (!m_repeat) {
         m_repeat = true;
-        m_crc = 0;
         m_command.clear();
         return setState(bs_recvCmd, RESULT_ERR_NAK, true);
       }
@@ -900,6 +1083,7 @@ result_t BusHandler::handleSymbol() {
     m_nextSendPos++;
     if (m_nextSendPos >= m_response.size()) {
       // slave data completely sent
+      m_crc = m_response.calcCrc();
       return setState(bs_sendResCrc, RESULT_OK);
     }
     return RESULT_OK;
@@ -926,11 +1110,16 @@ result_t BusHandler::handleSymbol() {
 }
 
 result_t BusHandler::setState(BusState state, result_t result, bool firstRepetition) {
+  if (result == RESULT_ERR_BUS_LOST || result == RESULT_ERR_SYMBOL) {
+    // lost arbitration or collision while sending
+    m_contentionCount++;
+    m_periodContentionCount++;
+  }
   if (m_currentRequest != NULL) {
     if (result == RESULT_ERR_BUS_LOST && m_currentRequest->m_busLostRetries < m_busLostRetries) {
       logDebug(lf_bus, "%s during %s, retry", getResultCode(result), getStateCode(m_state));
       m_currentRequest->m_busLostRetries++;
-      m_nextRequests.push(m_currentRequest);  // repeat
+      queueRequest(m_currentRequest);  // repeat
       m_currentRequest = NULL;
     } else if (state == bs_sendSyn || (result != RESULT_OK && !firstRepetition)) {
       logDebug(lf_bus, "notify request: %s", getResultCode(result));
@@ -938,16 +1127,17 @@ result_t BusHandler::setState(BusState state, result_t result, bool firstRepetit
       if (result == RESULT_OK) {
         addSeenAddress(dstAddress);
       }
-      bool restart = m_currentRequest->notify(
-        result == RESULT_ERR_SYN && (m_state == bs_recvCmdAck || m_state == bs_recvRes)
-        ? RESULT_ERR_TIMEOUT : result, m_response);
+      result_t notifyResult = result == RESULT_ERR_SYN && (m_state == bs_recvCmdAck || m_state == bs_recvRes)
+        ? RESULT_ERR_TIMEOUT : result;
+      if (notifyResult == RESULT_ERR_TIMEOUT) {
+        m_timeoutCount++;
+      }
+      bool restart = m_currentRequest->notify(notifyResult, m_response);
       if (restart) {
         m_currentRequest->m_busLostRetries = 0;
-        m_nextRequests.push(m_currentRequest);
-      } else if (m_currentRequest->m_deleteOnFinish) {
-        delete m_currentRequest;
+        queueRequest(m_currentRequest);
       } else {
-        m_finishedRequests.push(m_currentRequest);
+        finishRequest(m_currentRequest);
       }
       m_currentRequest = NULL;
     }
@@ -959,11 +1149,9 @@ result_t BusHandler::setState(BusState state, result_t result, bool firstRepetit
       bool restart = m_currentRequest->notify(RESULT_ERR_NO_SIGNAL, m_response);
       if (restart) {  // should not occur with no signal
         m_currentRequest->m_busLostRetries = 0;
-        m_nextRequests.push(m_currentRequest);
-      } else if (m_currentRequest->m_deleteOnFinish) {
-        delete m_currentRequest;
+        queueRequest(m_currentRequest);
       } else {
-        m_finishedRequests.push(m_currentRequest);
+        finishRequest(m_currentRequest);
       }
     }
   }
@@ -994,12 +1182,20 @@ result_t BusHandler::setState(BusState state, result_t result, bool firstRepetit
     m_response.clear();
     m_nextSendPos = 0;
     m_currentAnswering = false;
-  } else if (state == bs_recvRes || state == bs_sendRes) {
-    m_crc = 0;
   }
   return result;
 }
 
+void BusHandler::finishRequest(BusRequest* request) {
+  if (request == &m_pollRequest) {
+    m_pollRequestActive = false;  // available for the next poll
+  } else if (request->m_deleteOnFinish) {
+    delete request;
+  } else {
+    request->setFinished();
+  }
+}
+
 bool BusHandler::addSeenAddress(symbol_t address) {
   if (!isValidAddress(address, false)) {
     return false;
@@ -1036,6 +1232,27 @@ bool BusHandler::addSeenAddress(symbol_t address) {
   return m_addressConflict && !hadConflict;
 }
 
+void BusHandler::countCommand(MasterSymbolString& command, bool crcValid, time_t now) {
+  AddressTraffic& source = m_traffic[command[0]];
+  AddressTraffic::add(source.m_sentCount);
+  AddressTraffic::add(source.m_byteCount, static_cast<unsigned int>(command.size() + 1));
+  source.m_lastSeen.store(now, std::memory_order_relaxed);
+  if (!crcValid) {
+    AddressTraffic::add(source.m_crcErrorCount);
+  }
+  AddressTraffic::add(m_traffic[command[1]].m_receivedCount);
+}
+
+void BusHandler::countMissingAnswer() {
+  if (m_state != bs_recvCmdAck && m_state != bs_recvRes && m_state != bs_recvResCrc) {
+    return;
+  }
+  MasterSymbolString& command = getCurrentCommand();
+  if (command.size() > 1) {
+    AddressTraffic::add(m_traffic[command[1]].m_timeoutCount);
+  }
+}
+
 void BusHandler::receiveCompleted() {
   symbol_t srcAddress = m_command[0], dstAddress = m_command[1];
   if (srcAddress == dstAddress) {
@@ -1116,6 +1333,7 @@ void BusHandler::receiveCompleted() {
       logError(lf_update, "unable to parse %s %s from %s / %s: %s", circuit.c_str(), name.c_str(),
           m_command.getStr().c_str(), m_response.getStr().c_str(), getResultCode(result));
     } else {
+      m_receiveStats.addSince(m_lastSymbolTime);
       string data = output.str();
       if (m_answer && dstAddress == (master ? m_ownMasterAddress : m_ownSlaveAddress)) {
         logNotice(lf_update, "self-update %s %s QQ=%2.2x: %s", circuit.c_str(), name.c_str(), srcAddress,
@@ -1205,7 +1423,7 @@ result_t BusHandler::startScan(bool full, string levels) {
   }
   m_scanResults.clear();
   m_runningScans++;
-  m_nextRequests.push(request);
+  queueRequest(request);
   return RESULT_OK;
 }
 
@@ -1336,6 +1554,31 @@ void BusHandler::formatSeenInfo(ostringstream& output) {
   }
 }
 
+void BusHandler::formatTrafficInfo(ostringstream& output) {
+  time_t now;
+  time(&now);
+  for (unsigned int address = 0; address < 256; address++) {
+    const AddressTraffic& traffic = m_traffic[address];
+    time_t lastSeen = traffic.m_lastSeen.load(std::memory_order_relaxed);
+    if (lastSeen == 0 && AddressTraffic::get(traffic.m_receivedCount) == 0) {
+      continue;
+    }
+    output << endl << "traffic " << setfill('0') << setw(2) << hex << address << setw(0) << dec
+           << ": sent " << AddressTraffic::get(traffic.m_sentCount)
+           << ", received " << AddressTraffic::get(traffic.m_receivedCount)
+           << ", bytes " << AddressTraffic::get(traffic.m_byteCount)
+           << ", NAK " << AddressTraffic::get(traffic.m_nakCount)
+           << ", CRC errors " << AddressTraffic::get(traffic.m_crcErrorCount)
+           << ", timeouts " << AddressTraffic::get(traffic.m_timeoutCount);
+    if (m_responseStats[address].getCount() > 0) {
+      output << ", response avg " << m_responseStats[address].getAverage() << " us";
+    }
+    if (lastSeen > 0) {
+      output << ", last seen " << static_cast<unsigned>(now > lastSeen ? now - lastSeen : 0) << " s ago";
+    }
+  }
+}
+
 void BusHandler::formatUpdateInfo(ostringstream& output) {
   if (hasSignal()) {
     output << ",\"s\":" << m_maxSymPerSec;
@@ -1444,9 +1687,9 @@ result_t BusHandler::scanAndWait(symbol_t dstAddress, bool loadScanConfig, bool
       m_scanResults[dstAddress].resize(1);
     }
     m_runningScans++;
-    m_nextRequests.push(request);
-    bool success = m_finishedRequests.remove(request, true);
-    result = success ? request->m_result : RESULT_ERR_TIMEOUT;
+    queueRequest(request);
+    request->waitForFinish();
+    result = request->m_result;
     delete request;
     request = NULL;
   }
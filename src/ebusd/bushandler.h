@@ -21,6 +21,7 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
@@ -30,7 +31,9 @@
 #include "lib/ebus/symbol.h"
 #include "lib/ebus/result.h"
 #include "lib/ebus/device.h"
+#include "lib/utils/clock.h"
 #include "lib/utils/queue.h"
+#include "lib/utils/stats.h"
 #include "lib/utils/thread.h"
 
 namespace ebusd {
@@ -60,6 +63,15 @@ using std::string;
 /** the maximum allowed time [us] for retrieving back a sent symbol (2x symbol duration). */
 #define SEND_TIMEOUT (2*SYMBOL_DURATION)
 
+/** the number of master priority classes (lower nibble of the master address 0, 1, 3, 7, or F). */
+#define PRIORITY_CLASSES 5
+
+/** the nominal number of symbols per second on the bus (Start+8Bit+Stop @ 2400Bd). */
+#define SYMBOLS_PER_SECOND 240
+
+/** the number of symbols a contention event is accounted for in the bus load (about one telegram to repeat). */
+#define CONTENTION_SYMBOLS 20
+
 /** the possible bus states. */
 enum BusState {
   bs_noSignal,  //!< no signal on the bus
@@ -96,12 +108,34 @@ enum BusState {
 #define LOAD_DONE 0x10
 
 class BusHandler;
+class BusRequest;
+
+/**
+ * Interface for getting notified when a @a BusRequest is finished.
+ */
+class BusRequestListener {
+ public:
+  /**
+   * Destructor.
+   */
+  virtual ~BusRequestListener() {}
+
+  /**
+   * Called when the @a BusRequest is finished (usually from the @a BusHandler thread).
+   * @param request the finished @a BusRequest (owned by the listener from now on).
+   */
+  virtual void notifyFinished(BusRequest* request) = 0;
+};
+
 
 /**
  * Generic request for sending to and receiving from the bus.
+ * Requests not deleted on finish serve as completion handle: the creator can block on @a waitForFinish(), poll
+ * @a isFinished(), or set a @a BusRequestListener to be called on completion.
  */
 class BusRequest {
   friend class BusHandler;
+  friend class LinkedQueue<BusRequest>;
 
  public:
   /**
@@ -110,13 +144,19 @@ class BusRequest {
    * @param deleteOnFinish whether to automatically delete this @a BusRequest when finished.
    */
   BusRequest(MasterSymbolString& master, const bool deleteOnFinish)
-    : m_master(master), m_busLostRetries(0),
-      m_deleteOnFinish(deleteOnFinish) {}
+    : m_master(master), m_busLostRetries(0), m_queueTime(0),
+      m_deleteOnFinish(deleteOnFinish), m_queueNext(NULL), m_finished(false), m_listener(NULL) {
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond, NULL);
+  }
 
   /**
    * Destructor.
    */
-  virtual ~BusRequest() {}
+  virtual ~BusRequest() {
+    pthread_mutex_destroy(&m_mutex);
+    pthread_cond_destroy(&m_cond);
+  }
 
   /**
    * Notify the request of the specified result.
@@ -126,16 +166,96 @@ class BusRequest {
    */
   virtual bool notify(result_t result, SlaveSymbolString& slave) = 0;
 
+  /**
+   * Return whether this request may be delayed while the bus is congested.
+   * @return true if this request may be delayed in favor of other requests.
+   */
+  virtual bool isDeferrable() const { return false; }
+
+  /**
+   * Wait for this request being finished by the @a BusHandler.
+   * @param timeout the maximum time in seconds to wait, or 0 for waiting without limit.
+   * @return true when the request is finished, false when the time is over.
+   */
+  bool waitForFinish(int timeout = 0) {
+    struct timespec t;
+    if (timeout > 0) {
+      clockGettime(&t);
+      t.tv_sec += timeout;
+    }
+    pthread_mutex_lock(&m_mutex);
+    while (!m_finished) {
+      if (timeout <= 0) {
+        pthread_cond_wait(&m_cond, &m_mutex);
+      } else if (pthread_cond_timedwait(&m_cond, &m_mutex, &t) == ETIMEDOUT) {
+        break;
+      }
+    }
+    bool finished = m_finished;
+    pthread_mutex_unlock(&m_mutex);
+    return finished;
+  }
+
+  /**
+   * Return whether this request is finished without waiting.
+   * @return true when the request is finished.
+   */
+  bool isFinished() {
+    pthread_mutex_lock(&m_mutex);
+    bool finished = m_finished;
+    pthread_mutex_unlock(&m_mutex);
+    return finished;
+  }
+
+  /**
+   * Set the @a BusRequestListener to call when this request is finished (before passing it to the @a BusHandler).
+   * @param listener the @a BusRequestListener taking over this request on completion, or NULL.
+   */
+  void setListener(BusRequestListener* listener) { m_listener = listener; }
+
 
  protected:
+  /**
+   * Mark this request as finished, wake up the thread waiting for it, and call the @a BusRequestListener (which may
+   * delete this request).
+   */
+  void setFinished() {
+    pthread_mutex_lock(&m_mutex);
+    m_finished = true;
+    BusRequestListener* listener = m_listener;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+    if (listener) {
+      listener->notifyFinished(this);
+    }
+  }
+
   /** the master data @a MasterSymbolString to send. */
   MasterSymbolString& m_master;
 
   /** the number of times a send is repeated due to lost arbitration. */
   unsigned int m_busLostRetries;
 
+  /** the time when this request was added to the queue (see @a clockGetMicros()). */
+  uint64_t m_queueTime;
+
   /** whether to automatically delete this @a BusRequest when finished. */
   const bool m_deleteOnFinish;
+
+  /** the next @a BusRequest in the @a LinkedQueue this instance is currently part of. */
+  BusRequest* m_queueNext;
+
+  /** whether this request was finished (only for requests not deleted on finish). */
+  bool m_finished;
+
+  /** the @a BusRequestListener to call when this request is finished, or NULL. */
+  BusRequestListener* m_listener;
+
+  /** mutex variable for waiting on @a m_finished. */
+  pthread_mutex_t m_mutex;
+
+  /** condition variable for waiting on @a m_finished. */
+  pthread_cond_t m_cond;
 };
 
 
@@ -151,13 +271,23 @@ class PollRequest : public BusRequest {
    * @param message the associated @a Message.
    */
   explicit PollRequest(Message* message)
-    : BusRequest(m_master, true), m_message(message), m_index(0) {}
+    : BusRequest(m_master, false), m_message(message), m_index(0) {}
 
   /**
    * Destructor.
    */
   virtual ~PollRequest() {}
 
+  /**
+   * Reset this instance for reuse with another @a Message.
+   * @param message the associated @a Message.
+   */
+  void reset(Message* message) {
+    m_message = message;
+    m_index = 0;
+    m_busLostRetries = 0;
+  }
+
   /**
    * Prepare the master data.
    * @param masterAddress the master bus address to use.
@@ -168,6 +298,9 @@ class PollRequest : public BusRequest {
   // @copydoc
   bool notify(result_t result, SlaveSymbolString& slave) override;
 
+  // @copydoc
+  bool isDeferrable() const override { return true; }
+
 
  private:
   /** the master data @a MasterSymbolString. */
@@ -221,6 +354,9 @@ class ScanRequest : public BusRequest {
   // @copydoc
   bool notify(result_t result, SlaveSymbolString& slave) override;
 
+  // @copydoc
+  bool isDeferrable() const override { return m_deleteOnFinish; }
+
 
  private:
   /** the @a MessageMap instance. */
@@ -288,6 +424,94 @@ class ActiveBusRequest : public BusRequest {
 };
 
 
+/**
+ * An active @a BusRequest for reading several @a Message instances one after another that can be waited for.
+ */
+class MultiReadRequest : public BusRequest {
+  friend class BusHandler;
+
+ public:
+  /**
+   * Constructor.
+   * @param messageMap the @a MessageMap instance.
+   * @param messages the @a Message instances to read (in this order).
+   * @param failedSendRetries the number of times a failed read is repeated (other than lost arbitration).
+   * @param inputStr the input data for preparing each of the @a Message instances (e.g. the values to write).
+   */
+  MultiReadRequest(MessageMap* messageMap, const deque<Message*>& messages, const unsigned int failedSendRetries,
+      const string& inputStr = "")
+    : BusRequest(m_master, false), m_masterAddress(SYN), m_messageMap(messageMap), m_messages(messages),
+      m_inputStr(inputStr), m_results(messages.size(), RESULT_EMPTY), m_failedSendRetries(failedSendRetries),
+      m_current(0), m_index(0), m_sendRetries(0), m_waited(0) {}
+
+  /**
+   * Destructor.
+   */
+  virtual ~MultiReadRequest() {}
+
+  /**
+   * Prepare the master data for the next @a Message part, finishing all @a Message instances that can not be prepared.
+   * @param ownMasterAddress the own master bus address.
+   * @return true when the master data was prepared, false when all @a Message instances are finished.
+   */
+  bool prepare(symbol_t ownMasterAddress);
+
+  // @copydoc
+  bool notify(result_t result, SlaveSymbolString& slave) override;
+
+  /**
+   * Wait for the next @a Message being finished (in the order passed to the constructor).
+   * @param result set to the result of reading the @a Message.
+   * @return the finished @a Message, or NULL when all @a Message instances were already returned.
+   */
+  Message* waitForNext(result_t* result);
+
+
+ private:
+  /**
+   * Finish the current @a Message with the specified result and move on to the next one.
+   * @param result the result of reading the current @a Message.
+   */
+  void finishCurrent(result_t result);
+
+  /** the master data @a MasterSymbolString. */
+  MasterSymbolString m_master;
+
+  /** the own master address to use. */
+  symbol_t m_masterAddress;
+
+  /** the @a MessageMap instance. */
+  MessageMap* m_messageMap;
+
+  /** the @a Message instances to read. */
+  const deque<Message*> m_messages;
+
+  /** the input data for preparing each of the @a Message instances. */
+  const string m_inputStr;
+
+  /** the result for each of the @a Message instances. */
+  vector<result_t> m_results;
+
+  /** the number of times a failed read is repeated (other than lost arbitration). */
+  const unsigned int m_failedSendRetries;
+
+  /** the index of the currently read @a Message in @a m_messages. */
+  size_t m_current;
+
+  /** the current part index in the current @a Message. */
+  size_t m_index;
+
+  /** the number of times the current @a Message part was already repeated. */
+  unsigned int m_sendRetries;
+
+  /** the finished @a Message instances not yet returned by @a waitForNext(). */
+  Queue<Message*> m_finished;
+
+  /** the number of @a Message instances already returned by @a waitForNext(). */
+  size_t m_waited;
+};
+
+
 /**
  * Helper class for keeping track of grabbed messages.
  */
@@ -344,6 +568,58 @@ class GrabbedMessage {
 };
 
 
+/**
+ * The traffic counters of a single bus participant (updated by the bus thread, readable from any thread).
+ */
+class AddressTraffic {
+ public:
+  /**
+   * Construct a new instance.
+   */
+  AddressTraffic() : m_sentCount(0), m_receivedCount(0), m_byteCount(0), m_nakCount(0), m_crcErrorCount(0),
+    m_timeoutCount(0), m_lastSeen(0) {}
+
+  /**
+   * Increment one of the counters.
+   * @param counter the counter to increment.
+   * @param value the value to add.
+   */
+  static void add(std::atomic<unsigned int>& counter, unsigned int value = 1) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the value of one of the counters.
+   * @param counter the counter to read.
+   * @return the value of the counter.
+   */
+  static unsigned int get(const std::atomic<unsigned int>& counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  /** the number of telegrams sent by the participant as source. */
+  std::atomic<unsigned int> m_sentCount;
+
+  /** the number of telegrams addressed to the participant. */
+  std::atomic<unsigned int> m_receivedCount;
+
+  /** the number of symbols sent by the participant (command, response, ACK/NAK, and CRC). */
+  std::atomic<unsigned int> m_byteCount;
+
+  /** the number of NAKs received for a command or response sent by the participant. */
+  std::atomic<unsigned int> m_nakCount;
+
+  /** the number of CRC errors in a command or response sent by the participant. */
+  std::atomic<unsigned int> m_crcErrorCount;
+
+  /** the number of times the participant did not answer in time when addressed. */
+  std::atomic<unsigned int> m_timeoutCount;
+
+  /** the system time when the participant sent the last symbol, or 0 for never. */
+  std::atomic<time_t> m_lastSeen;
+};
+
+
 /**
  * Handles input from and output to the bus with respect to the eBUS protocol.
  */
@@ -363,13 +639,14 @@ class BusHandler : public WaitThread {
    * @param lockCount the number of AUTO-SYN symbols before sending is allowed after lost arbitration, or 0 for auto detection.
    * @param generateSyn whether to enable AUTO-SYN symbol generation.
    * @param pollInterval the interval in seconds in which poll messages are cycled, or 0 if disabled.
+   * @param busLoadLimit the bus load in percent above which polls and scans are delayed, or 0 if disabled.
    */
   BusHandler(Device* device, MessageMap* messages,
       const symbol_t ownAddress, const bool answer,
       const unsigned int busLostRetries, const unsigned int failedSendRetries,
       const unsigned int transferLatency, const unsigned int busAcquireTimeout, const unsigned int slaveRecvTimeout,
       const unsigned int lockCount, const bool generateSyn,
-      const unsigned int pollInterval)
+      const unsigned int pollInterval, const unsigned int busLoadLimit)
     : WaitThread(), m_device(device), m_reconnect(false), m_messages(messages),
       m_ownMasterAddress(ownAddress), m_ownSlaveAddress(getSlaveAddress(ownAddress)),
       m_answer(answer), m_addressConflict(false),
@@ -378,12 +655,18 @@ class BusHandler : public WaitThread {
       m_masterCount(device->isReadOnly()?0:1), m_autoLockCount(lockCount == 0),
       m_lockCount(lockCount <= 3 ? 3 : lockCount), m_remainLockCount(m_autoLockCount ? 1 : 0),
       m_generateSynInterval(generateSyn ? SYN_TIMEOUT*getMasterNumber(ownAddress)+SYMBOL_DURATION : 0),
-      m_pollInterval(pollInterval), m_lastReceive(0), m_lastPoll(0),
-      m_currentRequest(NULL), m_currentAnswering(false), m_runningScans(0), m_nextSendPos(0),
-      m_symPerSec(0), m_maxSymPerSec(0),
+      m_pollInterval(pollInterval), m_lastReceive(0), m_lastPoll(0), m_lastSymbolTime(0), m_lastSymbolSyn(false),
+      m_currentRequest(NULL), m_currentAnswering(false), m_pollRequest(NULL), m_pollRequestActive(false),
+      m_runningScans(0), m_nextSendPos(0),
+      m_symPerSec(0), m_maxSymPerSec(0), m_arbitrationLostCount(0), m_timeoutCount(0),
+      m_busLoadLimit(busLoadLimit), m_busLoad(0), m_busCongested(false), m_payloadSymbolCount(0),
+      m_synSymbolCount(0), m_periodContentionCount(0), m_payloadSymPerSec(0), m_synSymPerSec(0),
+      m_contentionCount(0), m_delayedPollCount(0),
       m_state(bs_noSignal), m_escape(0), m_crc(0), m_crcValid(false), m_repeat(false),
       m_grabMessages(true) {
     memset(m_seenAddresses, 0, sizeof(m_seenAddresses));
+    memset(m_arbitrationWonCounts, 0, sizeof(m_arbitrationWonCounts));
+    memset(m_arbitrationLostCounts, 0, sizeof(m_arbitrationLostCounts));
   }
 
   /**
@@ -393,18 +676,15 @@ class BusHandler : public WaitThread {
     stop();
     join();
     BusRequest* req;
-    while ((req = m_finishedRequests.pop()) != NULL) {
-      delete req;
-    }
     while ((req = m_nextRequests.pop()) != NULL) {
       if (req->m_deleteOnFinish) {
         delete req;
       }
     }
-    if (m_currentRequest != NULL) {
+    if (m_currentRequest != NULL && m_currentRequest != &m_pollRequest) {
       delete m_currentRequest;
-      m_currentRequest = NULL;
     }
+    m_currentRequest = NULL;
   }
 
   /**
@@ -431,6 +711,26 @@ class BusHandler : public WaitThread {
   result_t readFromBus(Message* message, string inputStr, const symbol_t dstAddress = SYN,
       const symbol_t srcAddress = SYN);
 
+  /**
+   * Create a @a MultiReadRequest for the @a Message instances and start reading them from the bus.
+   * Without @a listener, the caller has to take the results via @a MultiReadRequest::waitForNext() and has to pass
+   * the request to @a finishRead() afterwards. With @a listener, the request is passed to it once all @a Message
+   * instances are finished and the listener has to delete it.
+   * @param messages the @a Message instances to read (in this order).
+   * @param listener the optional @a BusRequestListener to notify when the request is finished.
+   * @param inputStr the optional input data for preparing each of the @a Message instances (e.g. the values to
+   * write).
+   * @return the started @a MultiReadRequest, or NULL when a @a listener was passed.
+   */
+  MultiReadRequest* startRead(const deque<Message*>& messages, BusRequestListener* listener = NULL,
+      const string& inputStr = "");
+
+  /**
+   * Wait for the @a MultiReadRequest to be completely finished and delete it.
+   * @param request the @a MultiReadRequest returned by @a startRead().
+   */
+  void finishRead(MultiReadRequest* request);
+
   /**
    * Main thread entry.
    */
@@ -478,6 +778,12 @@ class BusHandler : public WaitThread {
    */
   void formatSeenInfo(ostringstream& output);
 
+  /**
+   * Format the traffic counters of the participants seen so far to the @a ostringstream.
+   * @param output the @a ostringstream to append the info to.
+   */
+  void formatTrafficInfo(ostringstream& output);
+
   /**
    * Format information for running the update check to the @a ostringstream.
    * @param output the @a ostringstream to append the info to.
@@ -537,6 +843,115 @@ class BusHandler : public WaitThread {
    */
   unsigned int getMasterCount() { return m_masterCount; }
 
+  /**
+   * Return the number of times the arbitration was lost.
+   * @return the number of times the arbitration for sending a request was lost.
+   */
+  unsigned int getArbitrationLostCount() { return m_arbitrationLostCount; }
+
+  /**
+   * Return the number of requests that ended with a timeout.
+   * @return the number of requests that ended with a timeout.
+   */
+  unsigned int getTimeoutCount() { return m_timeoutCount; }
+
+  /**
+   * Return the estimated bus load.
+   * @return the moving average of the share of the nominal bus capacity used by symbols other than SYN and by
+   * contention events in percent.
+   */
+  unsigned int getBusLoad() const { return m_busLoad; }
+
+  /**
+   * Return the bus load limit.
+   * @return the bus load in percent above which polls and scans are delayed, or 0 if disabled.
+   */
+  unsigned int getBusLoadLimit() const { return m_busLoadLimit; }
+
+  /**
+   * Return whether polls and scans are currently delayed due to the bus load or contention.
+   * @return whether polls and scans are currently delayed.
+   */
+  bool isBusCongested() const { return m_busCongested; }
+
+  /**
+   * Return the current rate of received symbols other than SYN.
+   * @return the number of received symbols other than SYN per second in the last period.
+   */
+  unsigned int getPayloadSymbolRate() const { return m_payloadSymPerSec; }
+
+  /**
+   * Return the current rate of received SYN symbols.
+   * @return the number of received SYN symbols per second in the last period.
+   */
+  unsigned int getSynSymbolRate() const { return m_synSymPerSec; }
+
+  /**
+   * Return the number of contention events.
+   * @return the number of lost arbitrations and collisions while sending.
+   */
+  unsigned int getContentionCount() const { return m_contentionCount; }
+
+  /**
+   * Return the number of delayed polls.
+   * @return the number of times a due poll was skipped due to the bus load or contention.
+   */
+  unsigned int getDelayedPollCount() const { return m_delayedPollCount; }
+
+  /**
+   * Return the durations from the reception of the last symbol of a passive telegram until its data was decoded.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getReceiveStats() const { return m_receiveStats; }
+
+  /**
+   * Return the durations from adding a request to the queue until the arbitration for it was decided.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getQueueWaitStats() const { return m_queueWaitStats; }
+
+  /**
+   * Return the total durations of @a sendAndWait() including all retries.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getSendStats() const { return m_sendStats; }
+
+  /**
+   * Return the gaps between the reception of a symbol other than SYN and the previously received symbol.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getSymbolGapStats() const { return m_symbolGapStats; }
+
+  /**
+   * Return the intervals between two directly consecutive SYN symbols.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getSynIntervalStats() const { return m_synIntervalStats; }
+
+  /**
+   * Return the durations from the reception of the command CRC until the ACK/NAK of the addressed participant.
+   * @param address the addressed participant.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getResponseStats(symbol_t address) const { return m_responseStats[address]; }
+
+  /**
+   * Return the number of won or lost arbitrations for sending an own request.
+   * @param priorityClass the index of the priority class of the sending master (0 to @a PRIORITY_CLASSES - 1).
+   * @param won true for the won arbitrations, false for the lost ones.
+   * @return the number of won or lost arbitrations.
+   */
+  unsigned int getArbitrationCount(size_t priorityClass, bool won) const {
+    return (won ? m_arbitrationWonCounts : m_arbitrationLostCounts)[priorityClass];
+  }
+
+  /**
+   * Return the traffic counters of a participant.
+   * @param address the address of the participant.
+   * @return the @a AddressTraffic.
+   */
+  const AddressTraffic& getTraffic(symbol_t address) const { return m_traffic[address]; }
+
   /**
    * Get the next slave address that still needs to be scanned or loaded.
    * @param lastAddress the last returned slave address, or 0 for returning the first one.
@@ -576,11 +991,53 @@ class BusHandler : public WaitThread {
    */
   bool addSeenAddress(symbol_t address);
 
+  /**
+   * Return the command of the telegram currently on the bus.
+   * @return the master data of the own request being sent, or the received command.
+   */
+  MasterSymbolString& getCurrentCommand() {
+    return m_currentRequest ? m_currentRequest->m_master : m_command;
+  }
+
+  /**
+   * Count a completely sent or received command in the traffic counters.
+   * @param command the command @a MasterSymbolString (without CRC).
+   * @param crcValid whether the CRC matched.
+   * @param now the current system time.
+   */
+  void countCommand(MasterSymbolString& command, bool crcValid, time_t now);
+
+  /**
+   * Count a timeout in the traffic counters if the participant addressed by the current telegram did not answer.
+   */
+  void countMissingAnswer();
+
+  /**
+   * Update the bus load estimation from the symbols and contention events counted in the period just passed.
+   * @param seconds the duration of the period in seconds.
+   */
+  void updateBusLoad(unsigned int seconds);
+
   /**
    * Called when a passive reception was successfully completed.
    */
   void receiveCompleted();
 
+  /**
+   * Release a @a BusRequest that was notified and does not need to be restarted.
+   * @param request the finished @a BusRequest.
+   */
+  void finishRequest(BusRequest* request);
+
+  /**
+   * Add a @a BusRequest to the queue of requests to send.
+   * @param request the @a BusRequest to add.
+   */
+  void queueRequest(BusRequest* request) {
+    request->m_queueTime = clockGetMicros();
+    m_nextRequests.push(request);
+  }
+
   /**
    * Prepare a @a ScanRequest.
    * @param slave the single slave address to scan, or @a SYN for multiple.
@@ -652,8 +1109,14 @@ class BusHandler : public WaitThread {
   /** the time of the last poll, or 0 for never. */
   time_t m_lastPoll;
 
+  /** the time when the last symbol was received (see @a clockGetMicros()). */
+  uint64_t m_lastSymbolTime;
+
+  /** whether the last received symbol was SYN. */
+  bool m_lastSymbolSyn;
+
   /** the queue of @a BusRequests that shall be handled. */
-  Queue<BusRequest*> m_nextRequests;
+  LinkedQueue<BusRequest> m_nextRequests;
 
   /** the currently handled BusRequest, or NULL. */
   BusRequest* m_currentRequest;
@@ -661,8 +1124,11 @@ class BusHandler : public WaitThread {
   /** whether currently answering a request from another participant. */
   bool m_currentAnswering;
 
-  /** the queue of @a BusRequests that are already finished. */
-  Queue<BusRequest*> m_finishedRequests;
+  /** the preallocated @a PollRequest reused for each poll. */
+  PollRequest m_pollRequest;
+
+  /** whether @a m_pollRequest is currently queued or handled. */
+  bool m_pollRequestActive;
 
   /** the number of scan request currently running. */
   unsigned int m_runningScans;
@@ -677,13 +1143,73 @@ class BusHandler : public WaitThread {
   /** the maximum number of received symbols per second ever seen. */
   unsigned int m_maxSymPerSec;
 
+  /** the number of times the arbitration was lost. */
+  unsigned int m_arbitrationLostCount;
+
+  /** the number of requests that ended with a timeout. */
+  unsigned int m_timeoutCount;
+
+  /** the bus load in percent above which polls and scans are delayed, or 0 if disabled. */
+  const unsigned int m_busLoadLimit;
+
+  /** the moving average of the nominal bus capacity share used by payload symbols and contention in percent. */
+  unsigned int m_busLoad;
+
+  /** whether polls and scans are currently delayed due to the bus load or contention. */
+  bool m_busCongested;
+
+  /** the number of symbols other than SYN received in the current period. */
+  unsigned int m_payloadSymbolCount;
+
+  /** the number of SYN symbols received in the current period. */
+  unsigned int m_synSymbolCount;
+
+  /** the number of contention events in the current period. */
+  unsigned int m_periodContentionCount;
+
+  /** the number of received symbols other than SYN per second in the last period. */
+  unsigned int m_payloadSymPerSec;
+
+  /** the number of received SYN symbols per second in the last period. */
+  unsigned int m_synSymPerSec;
+
+  /** the number of lost arbitrations and collisions while sending. */
+  unsigned int m_contentionCount;
+
+  /** the number of times a due poll was skipped due to the bus load or contention. */
+  unsigned int m_delayedPollCount;
+
+  /** the durations from the reception of the last symbol of a passive telegram until its data was decoded. */
+  LatencyHistogram m_receiveStats;
+
+  /** the durations from adding a request to the queue until the arbitration for it was decided. */
+  LatencyHistogram m_queueWaitStats;
+
+  /** the total durations of @a sendAndWait() including all retries. */
+  LatencyHistogram m_sendStats;
+
+  /** the gaps between the reception of a symbol other than SYN and the previously received symbol. */
+  LatencyHistogram m_symbolGapStats;
+
+  /** the intervals between two directly consecutive SYN symbols. */
+  LatencyHistogram m_synIntervalStats;
+
+  /** the durations from the reception of the command CRC until the ACK/NAK by addressed participant. */
+  LatencyHistogram m_responseStats[256];
+
+  /** the number of won arbitrations for sending an own request by priority class. */
+  unsigned int m_arbitrationWonCounts[PRIORITY_CLASSES];
+
+  /** the number of lost arbitrations for sending an own request by priority class. */
+  unsigned int m_arbitrationLostCounts[PRIORITY_CLASSES];
+
   /** the current @a BusState. */
   BusState m_state;
 
   /** 0 when not escaping/unescaping, or @a ESC when receiving, or the original value when sending. */
   symbol_t m_escape;
 
-  /** the calculated CRC. */
+  /** the CRC calculated over the complete command or response. */
   symbol_t m_crc;
 
   /** whether the CRC matched. */
@@ -701,6 +1227,9 @@ class BusHandler : public WaitThread {
   /** the participating bus addresses seen so far (0 if not seen yet, or combination of @a SEEN bits). */
   symbol_t m_seenAddresses[256];
 
+  /** the traffic counters by participant address. */
+  AddressTraffic m_traffic[256];
+
   /** the scan results by slave address and index. */
   map<symbol_t, vector<string>> m_scanResults;
 
@@ -66,8 +66,39 @@ bool datahandler_register(UserInfo* userInfo, BusHandler* busHandler, MessageMap
 
 void DataSink::notifyUpdate(Message* message) {
   if (message && message->hasLevel(m_levels)) {
+    pthread_mutex_lock(&m_updatedMessagesMutex);
+    if (m_updatedMessages.empty()) {
+      m_updatedSince = clockGetMicros();
+    }
     m_updatedMessages[message]++;
+    pthread_mutex_unlock(&m_updatedMessagesMutex);
   }
 }
 
+void DataSink::notifyReload() {
+  pthread_mutex_lock(&m_updatedMessagesMutex);
+  m_updatedMessages.clear();
+  m_updatedSince = 0;
+  m_reloaded = true;
+  pthread_mutex_unlock(&m_updatedMessagesMutex);
+}
+
+uint64_t DataSink::takeUpdatedMessages(map<Message*, int>& updated) {
+  updated.clear();
+  pthread_mutex_lock(&m_updatedMessagesMutex);
+  updated.swap(m_updatedMessages);
+  uint64_t since = m_updatedSince;
+  m_updatedSince = 0;
+  pthread_mutex_unlock(&m_updatedMessagesMutex);
+  return since;
+}
+
+bool DataSink::checkReloaded() {
+  pthread_mutex_lock(&m_updatedMessagesMutex);
+  bool reloaded = m_reloaded;
+  m_reloaded = false;
+  pthread_mutex_unlock(&m_updatedMessagesMutex);
+  return reloaded;
+}
+
 }  // namespace ebusd
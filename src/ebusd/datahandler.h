@@ -20,11 +20,13 @@
 #define EBUSD_DATAHANDLER_H_
 
 #include <argp.h>
+#include <pthread.h>
 #include <map>
 #include <list>
 #include <string>
 #include "ebusd/bushandler.h"
 #include "lib/ebus/message.h"
+#include "lib/utils/stats.h"
 
 namespace ebusd {
 
@@ -123,6 +125,18 @@ class DataHandler {
    * @return whether this is a @a DataSource instance.
    */
   virtual bool isDataSource() const { return false; }
+
+  /**
+   * Return the name of this @a DataHandler for reporting statistics.
+   * @return the name of this @a DataHandler.
+   */
+  virtual string getName() const = 0;
+
+  /**
+   * Return the CPU time consumed by the own thread of this @a DataHandler.
+   * @return the consumed CPU time in microseconds, or 0 if not available.
+   */
+  virtual uint64_t getCpuTime() { return 0; }
 };
 
 
@@ -136,14 +150,17 @@ class DataSink : virtual public DataHandler {
    * @param userInfo the @a UserInfo instance.
    * @param user the user name for determining the allowed access levels (fall back to default levels).
    */
-  DataSink(UserInfo* userInfo, string user) {
+  DataSink(UserInfo* userInfo, string user) : m_updatedSince(0), m_reloaded(false) {
     m_levels = userInfo->getLevels(userInfo->hasUser(user) ? user : "");
+    pthread_mutex_init(&m_updatedMessagesMutex, NULL);
   }
 
   /**
    * Destructor.
    */
-  virtual ~DataSink() {}
+  virtual ~DataSink() {
+    pthread_mutex_destroy(&m_updatedMessagesMutex);
+  }
 
   // @copydoc
   bool isDataSink() const override { return true; }
@@ -160,12 +177,49 @@ class DataSink : virtual public DataHandler {
    */
   virtual void notifyUpdateCheckResult(string checkResult) {}
 
+  /**
+   * Notify the sink that the configuration was reloaded, i.e. all previously seen @a Message instances are gone.
+   */
+  virtual void notifyReload();
+
+  /**
+   * Return the durations from handing over updated @a Message instances to this sink until they were published.
+   * @return the @a LatencyHistogram.
+   */
+  const LatencyHistogram& getPublishStats() const { return m_publishStats; }
+
  protected:
+  /**
+   * Take over the @a Message instances updated since the last call.
+   * @param updated the map to move the updated @a Message instances to (cleared beforehand).
+   * @return the time when the oldest of the taken updates was handed over (see @a clockGetMicros()), or 0.
+   */
+  uint64_t takeUpdatedMessages(map<Message*, int>& updated);
+
+  /**
+   * Check whether the configuration was reloaded since the last call.
+   * @return true when the configuration was reloaded, i.e. any @a Message pointer kept by the sink is invalid now.
+   */
+  bool checkReloaded();
+
   /** the allowed access levels. */
   string m_levels;
 
+  /** the durations from handing over updated @a Message instances to this sink until they were published. */
+  LatencyHistogram m_publishStats;
+
+ private:
+  /** the mutex for access to @a m_updatedMessages and @a m_reloaded. */
+  pthread_mutex_t m_updatedMessagesMutex;
+
   /** a map of updated @p Message instances. */
   map<Message*, int> m_updatedMessages;
+
+  /** the time when the oldest entry in @a m_updatedMessages was added (see @a clockGetMicros()), or 0. */
+  uint64_t m_updatedSince;
+
+  /** whether the configuration was reloaded since the last call to @a checkReloaded(). */
+  bool m_reloaded;
 };
 
 
@@ -100,6 +100,7 @@ static struct options opt = {
   SLAVE_RECV_TIMEOUT*5/3,  // receiveTimeout
   0,  // masterCount
   false,  // generateSyn
+  0,  // busLoadLimit
 
   "",  // accessLevel
   "",  // aclFile
@@ -148,7 +149,8 @@ static const char argpdoc[] =
 #define O_RCVTIM (O_SNDRET+1)
 #define O_MASCNT (O_RCVTIM+1)
 #define O_GENSYN (O_MASCNT+1)
-#define O_ACLDEF (O_GENSYN+1)
+#define O_BUSLIM (O_GENSYN+1)
+#define O_ACLDEF (O_BUSLIM+1)
 #define O_ACLFIL (O_ACLDEF+1)
 #define O_HEXCMD (O_ACLFIL+1)
 #define O_PIDFIL (O_HEXCMD+1)
@@ -194,6 +196,7 @@ static const struct argp_option argpoptions[] = {
   {"receivetimeout", O_RCVTIM, "USEC",  0, "Expect a slave to answer within USEC us [25000]", 0 },
   {"numbermasters",  O_MASCNT, "COUNT", 0, "Expect COUNT masters on the bus, 0 for auto detection [0]", 0 },
   {"generatesyn",    O_GENSYN, NULL,    0, "Enable AUTO-SYN symbol generation", 0 },
+  {"busloadlimit",   O_BUSLIM, "PCT",   0, "Delay polls and scans above PCT percent bus load (0=disable) [0]", 0 },
 
   {NULL,             0,        NULL,    0, "Daemon options:", 4 },
   {"accesslevel",    O_ACLDEF, "LEVEL", 0, "Set default access level to LEVEL (\"*\" for everything) [\"\"]", 0 },
@@ -391,6 +394,13 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
       return EINVAL;
     }
     break;
+  case O_BUSLIM:  // --busloadlimit=0
+    opt->busLoadLimit = parseInt(arg, 10, 0, 100, result);
+    if (result != RESULT_OK) {
+      argp_error(state, "invalid busloadlimit");
+      return EINVAL;
+    }
+    break;
 
   // Daemon options:
   case O_ACLDEF:  // --accesslevel=*
@@ -668,12 +678,13 @@ void signalHandler(int sig) {
     }
     break;
   case SIGINT:
-    logNotice(lf_main, "SIGINT received");
-    shutdown();
-    break;
   case SIGTERM:
-    logNotice(lf_main, "SIGTERM received");
-    shutdown();
+    logNotice(lf_main, sig == SIGINT ? "SIGINT received" : "SIGTERM received");
+    if (s_mainLoop != NULL) {
+      s_mainLoop->shutdown();  // shutdown() is called once the main loop ended
+    } else {
+      shutdown();
+    }
     break;
   default:
     logNotice(lf_main, "undefined signal %s", strsignal(sig));
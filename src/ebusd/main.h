@@ -58,6 +58,7 @@ struct options {
   unsigned int receiveTimeout;  //!< timeout for receiving answer from slave in us [25000]
   unsigned int masterCount;  //!< expected number of masters for arbitration [0]
   bool generateSyn;  //!< enable AUTO-SYN symbol generation
+  unsigned int busLoadLimit;  //!< bus load in percent above which polls and scans are delayed, 0 to disable [0]
 
   const char* accessLevel;  //!< default access level
   const char* aclFile;  //!< ACL file name
@@ -36,10 +36,192 @@ using std::setfill;
 using std::setw;
 using std::endl;
 using std::ifstream;
+using std::min;
+using std::pair;
+using std::to_string;
 
 /** the number of seconds of permanent missing signal after which to reconnect the device. */
 #define RECONNECT_MISSING_SIGNAL 60
 
+/** the maximum HTTP body size sent without chunked transfer encoding (and the size of each chunk). */
+#define HTTP_CHUNK_SIZE 8192
+
+
+/**
+ * Compare two @a Message instances by circuit and name for sorting.
+ * @param first the first @a Message.
+ * @param second the second @a Message.
+ * @return true when the first @a Message is to be placed before the second one.
+ */
+static bool compareCircuitAndName(const Message* first, const Message* second) {
+  int cmp = first->getCircuit().compare(second->getCircuit());
+  return cmp < 0 || (cmp == 0 && first->getName() < second->getName());
+}
+
+/** the names of the master priority classes by index (lower nibble of the master address). */
+static const char* priorityClassNames[] = {"0", "1", "3", "7", "F"};
+
+/** the command aliases and the command names they stand for. */
+static const char* const commandAliases[][2] = {
+  {"A", "AUTH"}, {"R", "READ"}, {"W", "WRITE"}, {"F", "FIND"}, {"L", "LISTEN"}, {"S", "STATE"}, {"G", "GRAB"},
+  {"Q", "QUIT"}, {"I", "INFO"}, {"H", "HELP"}, {"?", "HELP"},
+};
+
+/**
+ * Append a label to the Prometheus metrics output with escaping the value.
+ * @param output the @a ostream to append to.
+ * @param name the label name.
+ * @param value the label value to escape.
+ */
+static void appendMetricLabel(ostream& output, const char* name, const string& value) {
+  output << name << "=\"";
+  for (const auto ch : value) {
+    if (ch == '\\' || ch == '"') {
+      output << '\\' << ch;
+    } else if (ch == '\n') {
+      output << "\\n";
+    } else {
+      output << ch;
+    }
+  }
+  output << '"';
+}
+
+/**
+ * Append the help and type lines of a metric family to the Prometheus metrics output.
+ * @param output the @a ostringstream to append to.
+ * @param name the metric name.
+ * @param type the metric type (e.g. "gauge").
+ * @param help the help text.
+ */
+static void appendMetricFamily(ostringstream& output, const char* name, const char* type, const char* help) {
+  output << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+/**
+ * Append the data in HTTP chunked transfer encoding (without the terminating last chunk).
+ * @param output the @a ostringstream to append to.
+ * @param data the data to append.
+ */
+static void appendHttpChunks(ostringstream& output, const string& data) {
+  for (size_t pos = 0; pos < data.length(); pos += HTTP_CHUNK_SIZE) {
+    size_t len = min(data.length() - pos, (size_t)HTTP_CHUNK_SIZE);
+    output << hex << len << dec << "\r\n";
+    output.write(data.c_str() + pos, len);
+    output << "\r\n";
+  }
+}
+
+/**
+ * Append the HTTP response header.
+ * @param output the @a ostringstream to append to.
+ * @param ret the result code of handling the request (@a RESULT_EMPTY for not modified).
+ * @param type the content type (7 for a stream of server-sent events).
+ * @param http11 true when the HTTP client uses protocol version 1.1.
+ * @param keepAlive true when the connection is kept open after the response.
+ * @param chunked true when the body is sent in chunked transfer encoding.
+ * @param length the length of the body, or -1 when unknown.
+ * @param etag the entity tag of the body, or empty.
+ */
+static void appendHttpHeader(ostringstream& output, result_t ret, int type, const bool http11, const bool keepAlive,
+    const bool chunked, const ssize_t length, const string& etag) {
+  output << (http11 ? "HTTP/1.1 " : "HTTP/1.0 ");
+  switch (ret) {
+  case RESULT_OK:
+    output << "200 OK\r\nContent-Type: ";
+    switch (type) {
+    case 1:
+      output << "text/css";
+      break;
+    case 2:
+      output << "application/javascript";
+      break;
+    case 3:
+      output << "image/png";
+      break;
+    case 4:
+      output << "image/jpeg";
+      break;
+    case 5:
+      output << "image/svg+xml";
+      break;
+    case 6:
+      output << "application/json;charset=utf-8";
+      break;
+    case 7:
+      output << "text/event-stream;charset=utf-8\r\nCache-Control: no-cache";
+      break;
+    case 8:
+      output << "text/plain;version=0.0.4;charset=utf-8";
+      break;
+    default:
+      output << "text/html";
+      break;
+    }
+    if (chunked) {
+      output << "\r\nTransfer-Encoding: chunked";
+    } else if (length >= 0) {
+      output << "\r\nContent-Length: " << setw(0) << dec << static_cast<unsigned>(length);
+    }
+    break;
+  case RESULT_EMPTY:
+    output << "304 Not Modified";
+    break;
+  case RESULT_ERR_NOTFOUND:
+    output << "404 Not Found";
+    break;
+  case RESULT_ERR_INVALID_ARG:
+  case RESULT_ERR_INVALID_NUM:
+  case RESULT_ERR_OUT_OF_RANGE:
+    output << "400 Bad Request";
+    break;
+  case RESULT_ERR_NOTAUTHORIZED:
+    output << "403 Forbidden";
+    break;
+  default:
+    output << "500 Internal Server Error";
+    break;
+  }
+  if (ret != RESULT_OK && ret != RESULT_EMPTY) {
+    output << "\r\nContent-Length: 0";
+  }
+  if (!etag.empty()) {
+    output << "\r\nETag: " << etag << "\r\nCache-Control: no-cache";
+  }
+  output << "\r\nConnection: " << (keepAlive ? "keep-alive" : "close");
+  output << "\r\nServer: " PACKAGE_NAME "/" PACKAGE_VERSION "\r\n\r\n";
+}
+
+/**
+ * Check whether the value of the "If-None-Match" HTTP request header matches the entity tag (weak comparison).
+ * @param header the value of the "If-None-Match" header.
+ * @param etag the current entity tag.
+ * @return true when the entity tag matches.
+ */
+static bool matchesEntityTag(const string& header, const string& etag) {
+  if (header.empty() || etag.empty()) {
+    return false;
+  }
+  if (header == "*") {
+    return true;
+  }
+  return header.find(etag.substr(etag.find('"'))) != string::npos;  // ignore the weak indicator
+}
+
+/**
+ * Append the data as single server-sent event.
+ * @param output the @a ostringstream to append to.
+ * @param data the (potentially multi-line) data of the event.
+ */
+static void appendServerSentEvent(ostringstream& output, const string& data) {
+  istringstream stream(data);
+  string line;
+  while (getline(stream, line)) {
+    output << "data: " << line << "\n";
+  }
+  output << "\n";
+}
+
 
 result_t UserList::getFieldMap(vector<string>& row, string& errorDescription, const string preferLanguage) const {
   // name,secret,level[,level]*
@@ -97,9 +279,32 @@ result_t UserList::addFromFile(map<string, string>& row, vector< map<string, str
 }
 
 
+void ReadAllCommand::notifyFinished(BusRequest* request) {
+  MultiReadRequest* readRequest = dynamic_cast<MultiReadRequest*>(request);
+  ostringstream result;
+  result_t ret = RESULT_EMPTY;
+  for (Message* message = readRequest->waitForNext(&ret); message != NULL;
+       message = readRequest->waitForNext(&ret)) {  // already finished
+    result << message->getCircuit() << " " << message->getName() << " = " << dec;
+    if (ret == RESULT_OK) {
+      ret = message->decodeLastData(result, m_verbosity);
+    }
+    if (ret != RESULT_OK) {
+      result << getResultCode(ret);
+    }
+    result << "\n";
+  }
+  result << "\n";
+  m_netMessage->setResult(result.str(), m_netMessage->getUser(), m_netMessage->isListening(),
+      m_netMessage->isDisconnect());
+  delete readRequest;
+  delete this;
+}
+
+
 MainLoop::MainLoop(const struct options opt, Device *device, MessageMap* messages)
-  : Thread(), m_device(device), m_reconnectCount(0), m_userList(opt.accessLevel), m_messages(messages),
-    m_address(opt.address), m_scanConfig(opt.scanConfig),
+  : Thread(), m_device(device), m_reconnectCount(0), m_shutdown(false), m_userList(opt.accessLevel),
+    m_messages(messages), m_address(opt.address), m_scanConfig(opt.scanConfig),
     m_initialScan(opt.initialScan), m_enableHex(opt.enableHex) {
   // open Device
   result_t result = m_device->open();
@@ -139,13 +344,14 @@ MainLoop::MainLoop(const struct options opt, Device *device, MessageMap* message
       opt.acquireRetries, opt.sendRetries,
       latency, opt.acquireTimeout, opt.receiveTimeout,
       opt.masterCount, opt.generateSyn,
-      opt.pollInterval);
+      opt.pollInterval, opt.busLoadLimit);
   m_busHandler->start("bushandler");
 
   // create network
   m_htmlPath = opt.htmlPath;
   m_network = new Network(opt.localOnly, opt.port, opt.httpPort, &m_netQueue);
   m_network->start("network");
+  Message::setListener(m_network);
   if (!datahandler_register(&m_userList, m_busHandler, messages, m_dataHandlers)) {
     logError(lf_main, "error registering data handlers");
   }
@@ -153,6 +359,11 @@ MainLoop::MainLoop(const struct options opt, Device *device, MessageMap* message
 
 MainLoop::~MainLoop() {
   join();
+  if (m_busHandler != NULL) {
+    // stop the bus first so that it no longer notifies the network or the data handlers being deleted below
+    m_busHandler->stop();
+    m_busHandler->join();
+  }
 
   for (list<DataHandler*>::iterator it = m_dataHandlers.begin(); it != m_dataHandlers.end(); it++) {
     delete *it;
@@ -166,6 +377,7 @@ MainLoop::~MainLoop() {
     m_logRawFile = NULL;
   }
   if (m_network != NULL) {
+    Message::setListener(NULL);
     delete m_network;
     m_network = NULL;
   }
@@ -191,7 +403,7 @@ MainLoop::~MainLoop() {
 
 void MainLoop::run() {
   bool reload = true;
-  time_t lastTaskRun, now, start, lastSignal = 0, since, sinkSince = 1, nextCheckRun;
+  time_t lastTaskRun, now, start, lastSignal = 0, sinkSince = 1, nextCheckRun;
   int taskDelay = 5;
   symbol_t lastScanAddress = 0;  // 0 is known to be a master
   time(&now);
@@ -208,7 +420,7 @@ void MainLoop::run() {
     }
     (*it)->start();
   }
-  while (true) {
+  while (!m_shutdown) {
     // pick the next message to handle
     NetMessage* netMessage = m_netQueue.pop(taskDelay);
     time(&now);
@@ -227,7 +439,7 @@ void MainLoop::run() {
         m_busHandler->reconnect();
         m_reconnectCount++;
       }
-      if (m_scanConfig) {
+      if (m_scanConfig && !m_busHandler->isBusCongested()) {  // scans are delayed while the bus is congested
         bool loadDelay = false;
         if (m_initialScan != ESC && reload && m_busHandler->hasSignal()) {
           loadDelay = true;
@@ -394,15 +606,28 @@ void MainLoop::run() {
     }
     string request = netMessage->getRequest();
     string user = netMessage->getUser();
-    bool listening = netMessage->isListening(&since);
-    if (!listening) {
-      since = now;
+    bool listening = netMessage->isListening();
+    bool wasListening = listening;
+    deque<Message*> updates;
+    if (listening && netMessage->isHttp()) {
+      netMessage->takeUpdates(updates);  // for the streaming answer
     }
     ostringstream ostream;
-    bool connected = true;
+    bool connected = !netMessage->isHttp() || netMessage->isHttpKeepAlive();
     if (request.length() > 0) {
       logDebug(lf_main, ">>> %s", request.c_str());
-      ostream << decodeMessage(request, netMessage->isHttp(), connected, listening, user, reload);
+      uint64_t start = clockGetMicros();
+      string command;
+      bool deferred = false;
+      string result = decodeMessage(request, netMessage, updates, connected, listening, user, reload, command,
+          deferred);
+      if (!command.empty()) {
+        m_commandStats[command].addSince(start);
+      }
+      if (deferred) {
+        continue;  // the result is set when the bus request is finished, the updates are kept for the next round
+      }
+      ostream << result;
 
       if (ostream.tellp() == 0 && !netMessage->isHttp()) {
         ostream << getResultCode(RESULT_EMPTY);
@@ -413,23 +638,37 @@ void MainLoop::run() {
         logDebug(lf_main, "<<< %s", ostream.str().c_str());
       }
       if (ostream.tellp() == 0) {
-        ostream << "\n";  // only for HTTP
+        if (!listening) {
+          ostream << "\n";  // only for HTTP
+        }
       } else if (!netMessage->isHttp()) {
         ostream << "\n\n";
       }
     }
-    if (listening) {
+    if (wasListening && !netMessage->isHttp()) {
+      // taken only after executing the command as a reload deletes all messages
+      netMessage->takeUpdates(updates);
+    }
+    if (listening && !wasListening) {
+      m_network->addListener(netMessage);
+    } else if (!listening && wasListening) {
+      m_network->removeListener(netMessage);
+    }
+    if (listening && !netMessage->isHttp() && !updates.empty()) {
       string levels = getUserLevels(user);
-      messages = m_messages->findAll("", "", levels, false, true, true, true, true, true, since, now);
-      for (deque<Message*>::iterator it = messages.begin(); it != messages.end(); it++) {
-        Message* message = *it;
+      sort(updates.begin(), updates.end(), compareCircuitAndName);
+      for (auto message : updates) {
+        if (message->getDstAddress() == SYN
+            || !m_messages->matches(message, "", "", levels, false, true, true, true, true, true)) {
+          continue;
+        }
         ostream << message->getCircuit() << " " << message->getName() << " = " << dec;
         message->decodeLastData(ostream);
         ostream << endl;
       }
     }
     // send result to client
-    netMessage->setResult(ostream.str(), user, listening, now, !connected);
+    netMessage->setResult(ostream.str(), user, listening, !connected);
   }
 }
 
@@ -448,8 +687,9 @@ void MainLoop::notifyDeviceData(const symbol_t symbol, bool received) {
   }
 }
 
-string MainLoop::decodeMessage(const string& data, const bool isHttp, bool& connected, bool& listening,
-    string& user, bool& reload) {
+string MainLoop::decodeMessage(const string& data, NetMessage* netMessage, const deque<Message*>& updates,
+    bool& connected, bool& listening, string& user, bool& reload, string& command, bool& deferred) {
+  bool isHttp = netMessage->isHttp();
   string token, previous;
   istringstream stream(data);
   vector<string> args;
@@ -486,13 +726,15 @@ string MainLoop::decodeMessage(const string& data, const bool isHttp, bool& conn
   if (isHttp) {
     const char* str = args.size() > 0 ? args[0].c_str() : "";
     if (strcmp(str, "GET") == 0) {
-      return executeGet(args, connected);
+      command = "HTTP GET";
+      return executeGet(args, netMessage, updates, connected, listening);
     }
     connected = false;
     return "HTTP/1.0 405 Method Not Allowed\r\n\r\n";
   }
 
   if (args.size() == 0) {
+    command = "HELP";
     return executeHelp();
   }
   string cmd = args[0];
@@ -509,13 +751,23 @@ string MainLoop::decodeMessage(const string& data, const bool isHttp, bool& conn
       args.clear();  // empty args is used as command help indicator
     }
   }
-  if (cmd == "AUTH" || cmd == "A") {
+  for (const auto& alias : commandAliases) {
+    if (cmd == alias[0]) {
+      cmd = alias[1];
+      break;
+    }
+  }
+  command = cmd;
+  if (cmd == "AUTH") {
     return executeAuth(args, user);
   }
-  if (cmd == "R" || cmd == "READ") {
+  if (cmd == "READ") {
     return executeRead(args, getUserLevels(user));
   }
-  if (cmd == "W" || cmd == "WRITE") {
+  if (cmd == "READALL") {
+    return executeReadAll(args, getUserLevels(user), netMessage, deferred);
+  }
+  if (cmd == "WRITE") {
     return executeWrite(args, getUserLevels(user));
   }
   if (cmd == "HEX") {
@@ -524,16 +776,16 @@ string MainLoop::decodeMessage(const string& data, const bool isHttp, bool& conn
     }
     return "ERR: command not enabled";
   }
-  if (cmd == "F" || cmd == "FIND") {
+  if (cmd == "FIND") {
     return executeFind(args, getUserLevels(user));
   }
-  if (cmd == "L" || cmd == "LISTEN") {
+  if (cmd == "LISTEN") {
     return executeListen(args, listening);
   }
-  if (cmd == "S" || cmd == "STATE") {
+  if (cmd == "STATE") {
     return executeState(args);
   }
-  if (cmd == "G" || cmd == "GRAB") {
+  if (cmd == "GRAB") {
     return executeGrab(args);
   }
   if (cmd == "SCAN") {
@@ -552,15 +804,19 @@ string MainLoop::decodeMessage(const string& data, const bool isHttp, bool& conn
     reload = true;
     return executeReload(args);
   }
-  if (cmd == "Q" || cmd == "QUIT") {
+  if (cmd == "QUIT") {
     return executeQuit(args, connected);
   }
-  if (cmd == "I" || cmd == "INFO") {
+  if (cmd == "INFO") {
     return executeInfo(args, user);
   }
-  if (cmd == "?" || cmd == "H" || cmd == "HELP") {
+  if (cmd == "STATS") {
+    return executeStats(args);
+  }
+  if (cmd == "HELP") {
     return executeHelp();
   }
+  command.clear();
   return "ERR: command not found";
 }
 
@@ -870,6 +1126,131 @@ string MainLoop::executeRead(vector<string> &args, const string levels) {
   return result.str();
 }
 
+string MainLoop::executeReadAll(vector<string> &args, const string levels, NetMessage* netMessage,
+    bool& deferred) {
+  size_t argPos = 1;
+  bool numeric = false, exact = false;
+  OutputFormat verbosity = 0;
+  time_t maxAge = 5*60;
+  string circuit;
+  while (args.size() > argPos && args[argPos][0] == '-') {
+    if (args[argPos] == "-f") {
+      maxAge = 0;
+    } else if (args[argPos] == "-v") {
+      switch (verbosity) {
+      case 0:
+        verbosity = OF_NAMES;
+        break;
+      case OF_NAMES:
+        verbosity |= OF_UNITS;
+        break;
+      case OF_NAMES|OF_UNITS:
+        verbosity |= OF_COMMENTS;
+        break;
+      }
+    } else if (args[argPos] == "-V") {
+      verbosity |= OF_NAMES|OF_UNITS|OF_COMMENTS;
+    } else if (args[argPos] == "-n") {
+      numeric = true;
+    } else if (args[argPos] == "-e") {
+      exact = true;
+    } else if (args[argPos] == "-m") {
+      argPos++;
+      result_t result = RESULT_ERR_INVALID_ARG;
+      if (args.size() > argPos) {
+        maxAge = parseInt(args[argPos].c_str(), 10, 0, 24*60*60, result);
+      }
+      if (result != RESULT_OK) {
+        argPos = 0;  // print usage
+        break;
+      }
+    } else if (args[argPos] == "-c") {
+      argPos++;
+      if (argPos >= args.size()) {
+        argPos = 0;  // print usage
+        break;
+      }
+      circuit = args[argPos];
+    } else {
+      argPos = 0;  // print usage
+      break;
+    }
+    argPos++;
+  }
+  if (argPos == 0 || args.size() < argPos) {
+    return "usage: readall [-f] [-m SECONDS] [-c CIRCUIT] [-e] [-v|-V] [-n] [[CIRCUIT/]NAME]*\n"
+        " Read the values of all matching messages, cached ones first and the remaining ones from the bus in a"
+        " single batch.\n"
+        "  -f           force reading from the bus (same as '-m 0')\n"
+        "  -m SECONDS   only return cached value if age is less than SECONDS [300]\n"
+        "  -c CIRCUIT   limit to messages of CIRCUIT\n"
+        "  -e           match CIRCUIT and NAME exactly\n"
+        "  -v           increase verbosity (include names/units/comments)\n"
+        "  -V           be very verbose (include names, units, and comments)\n"
+        "  -n           use numeric value of value=name pairs\n"
+        "  CIRCUIT      limit the following NAME to messages of CIRCUIT\n"
+        "  NAME         NAME of the messages to read (all if omitted)";
+  }
+  if (args.size() == argPos) {
+    args.push_back("");  // all messages
+  }
+  set<Message*> found;
+  deque<Message*> messages;
+  for (; argPos < args.size(); argPos++) {
+    string matchCircuit = circuit, name = args[argPos];
+    size_t pos = name.find('/');
+    if (pos != string::npos) {
+      matchCircuit = name.substr(0, pos);
+      name = name.substr(pos + 1);
+    }
+    for (auto message : m_messages->findAll(matchCircuit, name, levels, exact, true, false, true)) {
+      if (message->getDstAddress() != SYN && found.insert(message).second) {
+        messages.push_back(message);
+      }
+    }
+  }
+  if (messages.empty()) {
+    return getResultCode(RESULT_ERR_NOTFOUND);
+  }
+  sort(messages.begin(), messages.end(), compareCircuitAndName);
+  time_t now;
+  time(&now);
+  verbosity |= numeric ? OF_NUMERIC : 0;
+  ostringstream result;
+  deque<Message*> toRead;
+  for (const auto message : messages) {
+    // cached values first
+    if (!message->isPassive() && message->getLastUpdateTime() + maxAge <= now) {
+      toRead.push_back(message);
+      continue;
+    }
+    if (result.tellp() > 0) {
+      result << "\n";
+    }
+    result << message->getCircuit() << " " << message->getName() << " = " << dec;
+    if (message->getLastUpdateTime() == 0) {
+      result << "ERR: no data stored";  // passive message not seen yet
+      continue;
+    }
+    result_t ret = message->decodeLastData(result, verbosity);
+    if (ret != RESULT_OK) {
+      result << getResultCode(ret);
+    }
+  }
+  if (toRead.empty()) {
+    return result.str();
+  }
+  if (result.tellp() > 0) {
+    // send the cached values while reading the remaining ones from the bus
+    result << "\n";
+    netMessage->addResultPart(result.str());
+  }
+  logInfo(lf_main, "readall %d messages from bus", static_cast<int>(toRead.size()));
+  m_busHandler->startRead(toRead, new ReadAllCommand(netMessage, verbosity));  // result is set when done
+  deferred = true;
+  return "";
+}
+
 string MainLoop::executeWrite(vector<string> &args, const string levels) {
   size_t argPos = 1;
   bool hex = false;
@@ -1087,9 +1468,10 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
   bool configFormat = false, exact = false, withRead = true, withWrite = false, withPassive = true, first = true,
       onlyWithData = false, hexFormat = false, userLevel = true;
   OutputFormat verbosity = 0;
-  vector<string> fieldNames;
+  vector<string> fieldNames, dataFields;
   string circuit;
   vector<symbol_t> id;
+  MessagePatterns patterns;
   while (args.size() > argPos && args[argPos][0] == '-') {
     if (args[argPos] == "-v") {
       switch (verbosity) {
@@ -1184,6 +1566,34 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
       }
       levels = args[argPos];
       userLevel = false;
+    } else if (args[argPos] == "-m" || args[argPos] == "-x") {
+      bool exclude = args[argPos] == "-x";
+      argPos++;
+      if (argPos >= args.size()) {
+        argPos = 0;  // print usage
+        break;
+      }
+      result_t result = patterns.add(args[argPos], exclude);
+      if (result != RESULT_OK) {
+        return getResultCode(result);
+      }
+    } else if (args[argPos] == "-s") {
+      argPos++;
+      if (argPos >= args.size() || !dataFields.empty()) {
+        argPos = 0;  // print usage
+        break;
+      }
+      istringstream stream(args[argPos]);
+      string field;
+      while (getline(stream, field, FIELD_SEPARATOR)) {
+        if (!field.empty()) {
+          dataFields.push_back(field);
+        }
+      }
+      if (dataFields.empty()) {
+        argPos = 0;  // print usage
+        break;
+      }
     } else {
       argPos = 0;  // print usage
       break;
@@ -1192,7 +1602,7 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
   }
   if (argPos == 0 || args.size() < argPos || args.size() > argPos + 1) {
     return "usage: find [-v|-V] [-r] [-w] [-p] [-a] [-d] [-h] [-i ID] [-f] [-F COL[,COL]*] [-e] [-c CIRCUIT]"
-         " [-l LEVEL] [NAME]\n"
+         " [-l LEVEL] [-m REGEX]* [-x REGEX]* [-s FIELD[.N][,FIELD[.N]]*] [NAME]\n"
          " Find message(s).\n"
          "  -v             increase verbosity (include names/units/comments+destination address+update time)\n"
          "  -V             be very verbose (include everything)\n"
@@ -1209,10 +1619,14 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
          "  -e             match NAME and optional CIRCUIT exactly (ignoring case)\n"
          "  -c CIRCUIT     limit to messages of CIRCUIT (or a part thereof without '-e')\n"
          "  -l LEVEL       limit to messages with access LEVEL (\"*\" for any, default: current level)\n"
+         "  -m REGEX       limit to messages with \"CIRCUIT:NAME\" matching one of the extended regular expressions\n"
+         "  -x REGEX       exclude messages with \"CIRCUIT:NAME\" matching the extended regular expression\n"
+         "  -s FIELD[.N]   limit the decoded values to the field(s) named FIELD (or the N-th field named FIELD)\n"
          "  NAME           NAME of the messages to find (or a part thereof without '-e')";
   }
   deque<Message*> messages = m_messages->findAll(
-    circuit, args.size() == argPos ? "" : args[argPos], levels, exact, withRead, withWrite, withPassive, userLevel);
+    circuit, args.size() == argPos ? "" : args[argPos], levels, exact, withRead, withWrite, withPassive, userLevel,
+    true, 0, 0, &patterns);
 
   bool found = false;
   ostringstream result;
@@ -1237,6 +1651,14 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
       }
       message->dump(result, &fieldNames);
     } else {
+      ostringstream values;
+      result_t ret = RESULT_OK;
+      if (lastup != 0 && !hexFormat && !dataFields.empty()) {
+        ret = message->decodeLastDataFields(values, verbosity, false, dataFields);
+        if (ret == RESULT_EMPTY) {
+          continue;  // none of the selected fields is part of the message
+        }
+      }
       if (found) {
         result << endl;
       }
@@ -1246,7 +1668,11 @@ string MainLoop::executeFind(vector<string> &args, string levels) {
       } else if (hexFormat) {
         result << message->getLastMasterData().getStr() << " / " << message->getLastSlaveData().getStr();
       } else {
-        result_t ret = message->decodeLastData(result, verbosity);
+        if (dataFields.empty()) {
+          ret = message->decodeLastData(result, verbosity);
+        } else {
+          result << values.str();
+        }
         if (ret != RESULT_OK) {
           result << " (" << getResultCode(ret)
                << " for " << message->getLastMasterData().getStr()
@@ -1460,7 +1886,14 @@ string MainLoop::executeReload(vector<string> &args) {
          " Reload CSV config files.";
   }
   m_busHandler->clear();
+  m_metricLabels.clear();
+  for (list<DataHandler*>::iterator it = m_dataHandlers.begin(); it != m_dataHandlers.end(); it++) {
+    if ((*it)->isDataSink()) {
+      dynamic_cast<DataSink*>(*it)->notifyReload();
+    }
+  }
   result_t result = loadConfigFiles(m_messages);
+  m_network->clearUpdates();
   return getResultCode(result);
 }
 
@@ -1485,9 +1918,16 @@ string MainLoop::executeInfo(vector<string> &args, const string user) {
     result << "signal: acquired\n";
     result << "symbol rate: " << m_busHandler->getSymbolRate() << "\n";
     result << "max symbol rate: " << m_busHandler->getMaxSymbolRate() << "\n";
+    result << "bus load: " << m_busHandler->getBusLoad() << "%";
+    if (m_busHandler->getBusLoadLimit() > 0) {
+      result << " (limit " << m_busHandler->getBusLoadLimit() << "%"
+             << (m_busHandler->isBusCongested() ? ", delaying polls and scans" : "") << ")";
+    }
+    result << "\n";
   } else {
     result << "signal: no signal\n";
   }
+  formatStats(result, false);
   result << "reconnects: " << m_reconnectCount << "\n";
   result << "masters: " << m_busHandler->getMasterCount() << "\n";
   result << "messages: " << m_messages->size() << "\n";
@@ -1495,9 +1935,84 @@ string MainLoop::executeInfo(vector<string> &args, const string user) {
   result << "poll: " << m_messages->sizePoll() << "\n";
   result << "update: " << m_messages->sizePassive();
   m_busHandler->formatSeenInfo(result);
+  m_busHandler->formatTrafficInfo(result);
   return result.str();
 }
 
+string MainLoop::executeStats(vector<string> &args) {
+  if (args.size() != 1) {
+    return "usage: stats\n"
+           " Report the CPU time of the threads and the latency statistics.";
+  }
+  ostringstream result;
+  formatStats(result, true);
+  string str = result.str();
+  return str.substr(0, str.length() - 1);  // without trailing line feed
+}
+
+void MainLoop::getCpuTimes(vector<pair<string, uint64_t>>& times) {
+  times.push_back(pair<string, uint64_t>("mainloop", clockGetCpuMicros(self())));
+  times.push_back(pair<string, uint64_t>("bushandler", clockGetCpuMicros(m_busHandler->self())));
+  times.push_back(pair<string, uint64_t>("network", clockGetCpuMicros(m_network->self())));
+  times.push_back(pair<string, uint64_t>("connections", m_network->getConnectionCpuTime()));
+  for (const auto handler : m_dataHandlers) {
+    times.push_back(pair<string, uint64_t>(handler->getName(), handler->getCpuTime()));
+  }
+}
+
+void MainLoop::formatStats(ostringstream& output, bool full) {
+  vector<pair<string, uint64_t>> times;
+  getCpuTimes(times);
+  for (const auto& it : times) {
+    output << "cpu " << it.first << ": " << (it.second / 1000) << " ms\n";
+  }
+  output << "receive to decode: ";
+  m_busHandler->getReceiveStats().formatSummary(output);
+  output << "\nrequest queue wait: ";
+  m_busHandler->getQueueWaitStats().formatSummary(output);
+  output << "\nsend and wait: ";
+  m_busHandler->getSendStats().formatSummary(output);
+  output << "\n";
+  for (const auto handler : m_dataHandlers) {
+    if (handler->isDataSink()) {
+      output << handler->getName() << " update to publish: ";
+      dynamic_cast<DataSink*>(handler)->getPublishStats().formatSummary(output);
+      output << "\n";
+    }
+  }
+  if (!full) {
+    return;
+  }
+  output << "symbol gap: ";
+  m_busHandler->getSymbolGapStats().formatSummary(output);
+  output << "\nSYN interval: ";
+  m_busHandler->getSynIntervalStats().formatSummary(output);
+  output << "\nbus load: " << m_busHandler->getBusLoad() << "%, payload " << m_busHandler->getPayloadSymbolRate()
+         << " symbols/sec, SYN " << m_busHandler->getSynSymbolRate() << " symbols/sec, contention "
+         << m_busHandler->getContentionCount() << ", delayed polls " << m_busHandler->getDelayedPollCount() << "\n";
+  for (unsigned int address = 0; address < 256; address++) {
+    const LatencyHistogram& stats = m_busHandler->getResponseStats((symbol_t)address);
+    if (stats.getCount() > 0) {
+      output << "response " << hex << setw(2) << setfill('0') << address << dec << setw(0) << ": ";
+      stats.formatSummary(output);
+      output << "\n";
+    }
+  }
+  for (size_t priorityClass = 0; priorityClass < PRIORITY_CLASSES; priorityClass++) {
+    unsigned int won = m_busHandler->getArbitrationCount(priorityClass, true);
+    unsigned int lost = m_busHandler->getArbitrationCount(priorityClass, false);
+    if (won > 0 || lost > 0) {
+      output << "arbitration priority " << priorityClassNames[priorityClass] << ": won " << won << ", lost " << lost
+             << "\n";
+    }
+  }
+  for (const auto& it : m_commandStats) {
+    output << "command " << it.first << ": ";
+    it.second.formatSummary(output);
+    output << "\n";
+  }
+}
+
 string MainLoop::executeQuit(vector<string> &args, bool& connected) {
   if (args.size() == 1) {
     connected = false;
@@ -1512,6 +2027,7 @@ string MainLoop::executeHelp() {
       " read|r   Read value(s):         read [-f] [-m SECONDS] [-s QQ] [-d ZZ] [-c CIRCUIT] [-p PRIO] [-v|-V] [-n]"
       " [-i VALUE[;VALUE]*] NAME [FIELD[.N]]\n"
       "          Read hex message:      read [-f] [-m SECONDS] [-s QQ] [-c CIRCUIT] -h ZZPBSBNNDx\n"
+      " readall  Read many values:      readall [-f] [-m SECONDS] [-c CIRCUIT] [-e] [-v|-V] [-n] [[CIRCUIT/]NAME]*\n"
       " write|w  Write value(s):        write [-s QQ] [-d ZZ] -c CIRCUIT NAME [VALUE[;VALUE]*]\n"
       "          Write hex message:     write [-s QQ] [-c CIRCUIT] -h ZZPBSBNNDx\n"
       " auth|a   Authenticate user:     auth USER SECRET\n"
@@ -1521,6 +2037,7 @@ string MainLoop::executeHelp() {
       " listen|l Listen for updates:    listen [stop]\n"
       " state|s  Report bus state\n"
       " info|i   Report information about the daemon, the configuration, and seen devices.\n"
+      " stats    Report thread CPU times and latency statistics\n"
       " grab|g   Grab messages:         grab [stop]\n"
       "          Report the messages:   grab result [all]\n"
       " scan     Scan slaves:           scan [full|ZZ]\n"
@@ -1533,15 +2050,22 @@ string MainLoop::executeHelp() {
       " help|?   Print help             help [COMMAND], COMMMAND ?";
 }
 
-string MainLoop::executeGet(vector<string> &args, bool& connected) {
+string MainLoop::executeGet(vector<string> &args, NetMessage* netMessage, const deque<Message*>& updates,
+    bool& connected, bool& listening) {
   result_t ret = RESULT_OK;
-  bool numeric = false, required = false, full = false;
+  bool http11 = netMessage->isHttp11();
+  bool numeric = false, required = false, full = false, streaming = false, headerSent = false;
   OutputFormat verbosity = OF_NAMES;
   size_t argPos = 1;
   string uri = args[argPos++];
   ostringstream result;
   int type = -1;
 
+  if (uri == "/metrics") {
+    formatMetrics(result);
+    return formatHttpResult(RESULT_OK, result, 8, http11, connected);
+  }
+
   if (strncmp(uri.c_str(), "/data/", 6) == 0) {
     string circuit = "", name = "";
     size_t pos = uri.find('/', 6);
@@ -1551,10 +2075,12 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
       circuit = uri.substr(6, pos - 6);
       name = uri.substr(pos + 1);
     }
-    time_t since = 0;
+    time_t since = 0, maxAge = -1;
     size_t pollPriority = 0;
     bool exact = false;
-    string user = "";
+    string user = "", etag;
+    MessagePatterns patterns;
+    vector<string> dataFields;
     if (args.size() > argPos) {
       string secret;
       string query = args[argPos++];
@@ -1571,6 +2097,8 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
         }
         if (qname == "since") {
           since = parseInt(value.c_str(), 10, 0, 0xffffffff, ret);
+        } else if (qname == "maxage") {
+          maxAge = parseInt(value.c_str(), 10, 0, 24*60*60, ret);
         } else if (qname == "poll") {
           pollPriority = (size_t)parseInt(value.c_str(), 10, 1, 9, ret);
         } else if (qname == "exact") {
@@ -1589,6 +2117,18 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
           full = value.length() == 0 || value == "1";
         } else if (qname == "required") {
           required = value.length() == 0 || value == "1";
+        } else if (qname == "stream") {
+          streaming = value.length() == 0 || value == "1";
+        } else if (qname == "include" || qname == "exclude") {
+          ret = patterns.add(value, qname == "exclude");
+        } else if (qname == "fields") {
+          istringstream fieldStream(value);
+          string field;
+          while (getline(fieldStream, field, FIELD_SEPARATOR)) {
+            if (!field.empty()) {
+              dataFields.push_back(field);
+            }
+          }
         } else if (qname == "user") {
           user = value;
         } else if (qname == "secret") {
@@ -1607,10 +2147,62 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
     string lastCircuit = "";
     time_t maxLastUp = 0;
     if (ret == RESULT_OK) {
-      deque<Message *> messages = m_messages->findAll(circuit, name, getUserLevels(user), exact, true, false, true);
+      string levels = getUserLevels(user);
+      deque<Message*> messages;
+      if (listening) {
+        // streaming client: only the changed messages
+        for (auto message : updates) {
+          if (m_messages->matches(message, circuit, name, levels, exact, true, false, true)
+              && (patterns.empty() || patterns.matches((message->getCircuit()+":"+message->getName()).c_str()))) {
+            messages.push_back(message);
+          }
+        }
+        if (messages.empty()) {
+          return "";
+        }
+        sort(messages.begin(), messages.end(), compareCircuitAndName);
+      } else {
+        messages = m_messages->findAll(circuit, name, levels, exact, true, false, true, true, true, 0, 0,
+                                       &patterns);
+        if (!streaming && !required && since == 0 && maxAge < 0 && pollPriority == 0) {
+          // weak entity tag from the latest change of the selected messages (global values might differ)
+          unsigned int maxSequence = 0;
+          for (const auto message : messages) {
+            if (message->getDstAddress() != SYN && message->getLastChangeSequence() > maxSequence) {
+              maxSequence = message->getLastChangeSequence();
+            }
+          }
+          ostringstream tag;
+          tag << "W/\"" << hex << maxSequence << "-" << messages.size() << (m_busHandler->hasSignal() ? "s" : "")
+              << "\"";
+          etag = tag.str();
+          if (matchesEntityTag(netMessage->getHttpIfNoneMatch(), etag)) {
+            return formatHttpResult(RESULT_EMPTY, result, type, http11, connected, etag);
+          }
+        }
+      }
 
-      bool first = true;
+      MultiReadRequest* readRequest = NULL;
+      deque<Message*> toRead;
+      size_t readPos = 0;
+      if (!listening && (required || maxAge >= 0)) {
+        // read all outdated messages from the bus in a single batch and wait for each result when needed below
+        time_t now;
+        time(&now);
+        for (const auto message : messages) {
+          time_t lastup = message->getLastUpdateTime();
+          if (message->getDstAddress() != SYN && !message->isPassive()
+              && ((required && lastup == 0) || (maxAge >= 0 && lastup + maxAge <= now))) {
+            toRead.push_back(message);
+          }
+        }
+        if (!toRead.empty()) {
+          readRequest = m_busHandler->startRead(toRead);
+        }
+      }
+      bool first = true, sendParts = !streaming && !listening;
       verbosity |= (numeric ? OF_NUMERIC : 0) | OF_JSON | (full ? OF_ALL_ATTRS : 0);
+      result_t readResult;
       for (deque<Message*>::iterator it = messages.begin(); it != messages.end();) {
         Message* message = *it++;
         symbol_t dstAddress = message->getDstAddress();
@@ -1620,36 +2212,41 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
         if (pollPriority > 0 && message->setPollPriority(pollPriority)) {
           m_messages->addPollMessage(message);
         }
+        if (readPos < toRead.size() && toRead[readPos] == message) {
+          readRequest->waitForNext(&readResult);  // finished in the same order
+          readPos++;
+        }
         time_t lastup = message->getLastUpdateTime();
         if (lastup == 0 && required) {
-          // read directly from bus
-          if (message->isPassive()) {
-            continue;  // not possible to actively read this message
-          }
-          if (m_busHandler->readFromBus(message, "") != RESULT_OK) {
-            continue;
-          }
-          lastup = message->getLastUpdateTime();
-        } else {
-          if (since > 0 && lastup <= since) {
-            continue;
-          }
-          if (lastup > maxLastUp) {
-            maxLastUp = lastup;
-          }
+          continue;  // not available (e.g. passive or failed to read from bus)
+        }
+        if (since > 0 && lastup <= since) {
+          continue;
+        }
+        if (lastup > maxLastUp) {
+          maxLastUp = lastup;
         }
         if (message->getCircuit() != lastCircuit) {
           if (lastCircuit.length() > 0) {
             result << "\n },";
           }
           lastCircuit = message->getCircuit();
-          result << "\n \"" << lastCircuit << "\": {";
+          result << "\n ";
+          appendJsonString(result, lastCircuit);
+          result << ": {";
           first = true;
           if (full && m_messages->decodeCircuit(lastCircuit, result, verbosity)) {  // add circuit specific values
             first = false;
           }
         }
-        message->decode(result, verbosity, !first);
+        message->decode(result, verbosity, !first, dataFields.empty() ? NULL : &dataFields);
+        first = false;
+        if (sendParts && result.tellp() >= HTTP_CHUNK_SIZE) {
+          sendParts = sendHttpResultPart(netMessage, result, etag, headerSent, connected);
+        }
+      }
+      if (readRequest) {
+        m_busHandler->finishRead(readRequest);
       }
 
       if (lastCircuit.length() > 0) {
@@ -1658,19 +2255,22 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
       result << "\n \"global\": {";
       result << "\n  \"version\": \"" << PACKAGE_VERSION "." REVISION "\"";
       if (!m_updateCheck.empty()) {
-        result << ",\n  \"updatecheck\": \"" << m_updateCheck << "\"";
+        result << ",\n  \"updatecheck\": ";
+        appendJsonString(result, m_updateCheck);
       }
       if (!user.empty()) {
-        result << ",\n  \"user\": \"" << user << "\"";
+        result << ",\n  \"user\": ";
+        appendJsonString(result, user);
       }
-      string levels = getUserLevels(user);
       if (!user.empty() || !levels.empty()) {
-        result << ",\n  \"access\": \"" << levels << "\"";
+        result << ",\n  \"access\": ";
+        appendJsonString(result, levels);
       }
       result << ",\n  \"signal\": " << (m_busHandler->hasSignal() ? "1" : "0");
       if (m_busHandler->hasSignal()) {
         result << ",\n  \"symbolrate\": " << m_busHandler->getSymbolRate();
         result << ",\n  \"maxsymbolrate\": " << m_busHandler->getMaxSymbolRate();
+        result << ",\n  \"busload\": " << m_busHandler->getBusLoad();
       }
       result << ",\n  \"reconnects\": " << m_reconnectCount;
       result << ",\n  \"masters\": " << m_busHandler->getMasterCount();
@@ -1680,8 +2280,37 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
       result << "\n}";
       type = 6;
     }
-    connected = false;
-    return formatHttpResult(ret, result, type);
+    if (ret == RESULT_OK && (streaming || listening)) {
+      string data = result.str();
+      result.str("");
+      result.clear();
+      appendServerSentEvent(result, data);
+      if (listening) {
+        if (!http11) {
+          return result.str();
+        }
+        data = result.str();
+        result.str("");
+        result.clear();
+        appendHttpChunks(result, data);
+        return result.str();
+      }
+      listening = connected = true;
+      type = 7;
+    }
+    if (headerSent) {
+      // remainder of the response already started in sendHttpResultPart()
+      if (!http11) {
+        return result.str();
+      }
+      string data = result.str();
+      result.str("");
+      result.clear();
+      appendHttpChunks(result, data);
+      result << "0\r\n\r\n";
+      return result.str();
+    }
+    return formatHttpResult(ret, result, type, http11, connected, etag);
   }  // request for "/data/..."
 
   if (uri.length() < 1 || uri[0] != '/' || uri.find("//") != string::npos || uri.find("..") != string::npos) {
@@ -1723,61 +2352,260 @@ string MainLoop::executeGet(vector<string> &args, bool& connected) {
       }
     }
   }
-  connected = false;
-  return formatHttpResult(ret, result, type);
+  return formatHttpResult(ret, result, type, http11, connected);
+}
+
+void MainLoop::formatMetrics(ostringstream& output) {
+  char str[32];
+  output << setw(0) << dec;
+  appendMetricFamily(output, "ebusd_signal", "gauge", "Whether a signal on the bus is available.");
+  output << "ebusd_signal " << (m_busHandler->hasSignal() ? 1 : 0) << "\n";
+  appendMetricFamily(output, "ebusd_symbol_rate", "gauge", "Number of received symbols in the last second.");
+  output << "ebusd_symbol_rate " << m_busHandler->getSymbolRate() << "\n";
+  appendMetricFamily(output, "ebusd_symbol_rate_max", "gauge", "Maximum number of received symbols per second.");
+  output << "ebusd_symbol_rate_max " << m_busHandler->getMaxSymbolRate() << "\n";
+  appendMetricFamily(output, "ebusd_payload_symbol_rate", "gauge",
+      "Number of received symbols other than SYN per second in the last period.");
+  output << "ebusd_payload_symbol_rate " << m_busHandler->getPayloadSymbolRate() << "\n";
+  appendMetricFamily(output, "ebusd_syn_symbol_rate", "gauge",
+      "Number of received SYN symbols per second in the last period.");
+  output << "ebusd_syn_symbol_rate " << m_busHandler->getSynSymbolRate() << "\n";
+  appendMetricFamily(output, "ebusd_bus_load_percent", "gauge",
+      "Moving average of the nominal bus capacity used by symbols other than SYN.");
+  output << "ebusd_bus_load_percent " << m_busHandler->getBusLoad() << "\n";
+  appendMetricFamily(output, "ebusd_bus_congested", "gauge",
+      "Whether polls and scans are delayed due to bus load or contention.");
+  output << "ebusd_bus_congested " << (m_busHandler->isBusCongested() ? 1 : 0) << "\n";
+  appendMetricFamily(output, "ebusd_bus_contentions_total", "counter",
+      "Number of lost arbitrations and collisions while sending.");
+  output << "ebusd_bus_contentions_total " << m_busHandler->getContentionCount() << "\n";
+  appendMetricFamily(output, "ebusd_polls_delayed_total", "counter",
+      "Number of poll cycles skipped due to bus congestion.");
+  output << "ebusd_polls_delayed_total " << m_busHandler->getDelayedPollCount() << "\n";
+  appendMetricFamily(output, "ebusd_masters", "gauge", "Number of masters seen on the bus.");
+  output << "ebusd_masters " << m_busHandler->getMasterCount() << "\n";
+  appendMetricFamily(output, "ebusd_arbitration_lost_total", "counter", "Number of lost arbitrations.");
+  output << "ebusd_arbitration_lost_total " << m_busHandler->getArbitrationLostCount() << "\n";
+  appendMetricFamily(output, "ebusd_request_timeouts_total", "counter", "Number of requests ended with a timeout.");
+  output << "ebusd_request_timeouts_total " << m_busHandler->getTimeoutCount() << "\n";
+  appendMetricFamily(output, "ebusd_reconnects_total", "counter", "Number of device reconnects.");
+  output << "ebusd_reconnects_total " << m_reconnectCount << "\n";
+  appendMetricFamily(output, "ebusd_messages", "gauge", "Number of known messages.");
+  output << "ebusd_messages " << m_messages->size() << "\n";
+  vector<pair<string, uint64_t>> times;
+  getCpuTimes(times);
+  appendMetricFamily(output, "ebusd_thread_cpu_seconds_total", "counter", "CPU time consumed by a thread.");
+  for (const auto& it : times) {
+    snprintf(str, sizeof(str), "%.6f", static_cast<double>(it.second) / 1000000);
+    output << "ebusd_thread_cpu_seconds_total{";
+    appendMetricLabel(output, "thread", it.first);
+    output << "} " << str << "\n";
+  }
+  appendMetricFamily(output, "ebusd_receive_decode_seconds", "histogram",
+      "Duration from receiving the end of a passive telegram until its data was decoded.");
+  m_busHandler->getReceiveStats().formatMetrics(output, "ebusd_receive_decode_seconds");
+  appendMetricFamily(output, "ebusd_request_queue_wait_seconds", "histogram",
+      "Duration from queueing a request until the arbitration for it was decided.");
+  m_busHandler->getQueueWaitStats().formatMetrics(output, "ebusd_request_queue_wait_seconds");
+  appendMetricFamily(output, "ebusd_send_seconds", "histogram",
+      "Total duration of sending a message and waiting for the answer including retries.");
+  m_busHandler->getSendStats().formatMetrics(output, "ebusd_send_seconds");
+  appendMetricFamily(output, "ebusd_symbol_gap_seconds", "histogram",
+      "Gap between the reception of a symbol other than SYN and the previous symbol.");
+  m_busHandler->getSymbolGapStats().formatMetrics(output, "ebusd_symbol_gap_seconds");
+  appendMetricFamily(output, "ebusd_syn_interval_seconds", "histogram",
+      "Interval between two consecutive SYN symbols.");
+  m_busHandler->getSynIntervalStats().formatMetrics(output, "ebusd_syn_interval_seconds");
+  appendMetricFamily(output, "ebusd_response_seconds", "histogram",
+      "Duration from the command CRC until the ACK/NAK of the addressed participant.");
+  for (unsigned int address = 0; address < 256; address++) {
+    const LatencyHistogram& stats = m_busHandler->getResponseStats((symbol_t)address);
+    if (stats.getCount() > 0) {
+      snprintf(str, sizeof(str), "address=\"%2.2x\"", address);
+      stats.formatMetrics(output, "ebusd_response_seconds", str);
+    }
+  }
+  appendMetricFamily(output, "ebusd_arbitrations_total", "counter",
+      "Number of won and lost arbitrations for own requests by priority class.");
+  for (size_t priorityClass = 0; priorityClass < PRIORITY_CLASSES; priorityClass++) {
+    for (int won = 1; won >= 0; won--) {
+      output << "ebusd_arbitrations_total{priority=\"" << priorityClassNames[priorityClass] << "\",result=\""
+             << (won ? "won" : "lost") << "\"} " << m_busHandler->getArbitrationCount(priorityClass, won) << "\n";
+    }
+  }
+  vector<symbol_t> addresses;
+  for (unsigned int address = 0; address < 256; address++) {
+    const AddressTraffic& traffic = m_busHandler->getTraffic((symbol_t)address);
+    if (traffic.m_lastSeen.load(std::memory_order_relaxed) != 0 || AddressTraffic::get(traffic.m_receivedCount) != 0) {
+      addresses.push_back((symbol_t)address);
+    }
+  }
+  static const struct {
+    const char* name;
+    const char* help;
+    std::atomic<unsigned int> AddressTraffic::*counter;
+  } trafficCounters[] = {
+    {"ebusd_address_sent_total", "Number of telegrams sent by a participant.", &AddressTraffic::m_sentCount},
+    {"ebusd_address_received_total", "Number of telegrams addressed to a participant.",
+        &AddressTraffic::m_receivedCount},
+    {"ebusd_address_bytes_total", "Number of symbols sent by a participant.", &AddressTraffic::m_byteCount},
+    {"ebusd_address_naks_total", "Number of NAKs received for data sent by a participant.",
+        &AddressTraffic::m_nakCount},
+    {"ebusd_address_crc_errors_total", "Number of CRC errors in data sent by a participant.",
+        &AddressTraffic::m_crcErrorCount},
+    {"ebusd_address_timeouts_total", "Number of times a participant did not answer in time.",
+        &AddressTraffic::m_timeoutCount},
+  };
+  for (const auto& counter : trafficCounters) {
+    appendMetricFamily(output, counter.name, "counter", counter.help);
+    for (const auto address : addresses) {
+      snprintf(str, sizeof(str), "{address=\"%2.2x\"} ", address);
+      output << counter.name << str << AddressTraffic::get(m_busHandler->getTraffic(address).*counter.counter) << "\n";
+    }
+  }
+  appendMetricFamily(output, "ebusd_address_last_seen_seconds", "gauge",
+      "Time of the last symbol sent by a participant.");
+  for (const auto address : addresses) {
+    snprintf(str, sizeof(str), "{address=\"%2.2x\"} ", address);
+    output << "ebusd_address_last_seen_seconds" << str
+           << static_cast<unsigned>(m_busHandler->getTraffic(address).m_lastSeen.load(std::memory_order_relaxed))
+           << "\n";
+  }
+  appendMetricFamily(output, "ebusd_update_publish_seconds", "histogram",
+      "Duration from handing over updated messages to a data handler until they were published.");
+  for (const auto handler : m_dataHandlers) {
+    if (handler->isDataSink()) {
+      ostringstream label;
+      appendMetricLabel(label, "handler", handler->getName());
+      dynamic_cast<DataSink*>(handler)->getPublishStats().formatMetrics(output, "ebusd_update_publish_seconds",
+          label.str());
+    }
+  }
+  appendMetricFamily(output, "ebusd_command_seconds", "histogram", "Execution time of a client command.");
+  for (const auto& it : m_commandStats) {
+    ostringstream label;
+    appendMetricLabel(label, "command", it.first);
+    it.second.formatMetrics(output, "ebusd_command_seconds", label.str());
+  }
+
+  deque<Message*> messages = m_messages->findAll("", "", getUserLevels(""), false, true, false, true);
+  vector<pair<const Message*, MetricLabels*>> selected;
+  vector<DataValue> values;
+  vector<string> names;
+  for (const auto message : messages) {
+    if (message->getLastUpdateTime() == 0) {
+      continue;
+    }
+    MetricLabels& labels = m_metricLabels[message];
+    if (labels.m_message.empty()) {
+      ostringstream label;
+      appendMetricLabel(label, "circuit", message->getCircuit());
+      label << ",";
+      appendMetricLabel(label, "name", message->getName());
+      labels.m_message = label.str();
+    }
+    selected.push_back(pair<const Message*, MetricLabels*>(message, &labels));
+  }
+  appendMetricFamily(output, "ebusd_message_updates_total", "counter", "Number of updates of the message data.");
+  for (const auto& it : selected) {
+    output << "ebusd_message_updates_total{" << it.second->m_message << "} " << it.first->getUpdateCount() << "\n";
+  }
+  appendMetricFamily(output, "ebusd_message_lastup_seconds", "gauge", "Time of the last message data update.");
+  for (const auto& it : selected) {
+    output << "ebusd_message_lastup_seconds{" << it.second->m_message << "} "
+           << static_cast<unsigned>(it.first->getLastUpdateTime()) << "\n";
+  }
+  appendMetricFamily(output, "ebusd_field_value", "gauge", "Value of a numeric message field.");
+  for (const auto& it : selected) {
+    const Message* message = it.first;
+    MetricLabels* labels = it.second;
+    values.clear();
+    if (message->decodeLastDataValues(values) != RESULT_OK) {
+      continue;
+    }
+    if (values.size() != labels->m_fields.size()) {
+      // render the field labels once (or again if the layout changed)
+      values.clear();
+      names.clear();
+      if (message->decodeLastDataValues(values, &names) != RESULT_OK) {
+        continue;
+      }
+      labels->m_fields.clear();
+      for (size_t index = 0; index < names.size(); index++) {
+        string field = names[index];
+        size_t count = 0;
+        for (size_t previous = 0; previous < index; previous++) {
+          if (names[previous] == names[index]) {
+            count++;
+          }
+        }
+        if (field.empty()) {
+          field = to_string(index);
+        } else if (count > 0) {
+          field += "." + to_string(count);
+        }
+        ostringstream label;
+        label << labels->m_message << ",";
+        appendMetricLabel(label, "field", field);
+        labels->m_fields.push_back(label.str());
+      }
+    }
+    for (size_t index = 0; index < values.size(); index++) {
+      if (!values[index].isNumeric()) {
+        continue;  // replacement value or non-numeric field
+      }
+      snprintf(str, sizeof(str), "%.10g", values[index].getFloat());
+      output << "ebusd_field_value{" << labels->m_fields[index] << "} " << str << "\n";
+    }
+  }
 }
 
-string MainLoop::formatHttpResult(result_t ret, ostringstream& result, int type) {
+string MainLoop::formatHttpResult(result_t ret, ostringstream& result, int type, const bool http11,
+    const bool keepAlive, const string& etag) {
   string data = ret == RESULT_OK ? result.str() : "";
+  bool stream = type == 7;
+  bool chunked = http11 && (stream || data.length() > HTTP_CHUNK_SIZE);
   result.str("");
   result.clear();
-  result << "HTTP/1.0 ";
-  switch (ret) {
-  case RESULT_OK:
-    result << "200 OK\r\nContent-Type: ";
-    switch (type) {
-    case 1:
-      result << "text/css";
-      break;
-    case 2:
-      result << "application/javascript";
-      break;
-    case 3:
-      result << "image/png";
-      break;
-    case 4:
-      result << "image/jpeg";
-      break;
-    case 5:
-      result << "image/svg+xml";
-      break;
-    case 6:
-      result << "application/json;charset=utf-8";
-      break;
-    default:
-      result << "text/html";
-      break;
-    }
-    result << "\r\nContent-Length: " << setw(0) << dec << static_cast<unsigned>(data.length());
-    break;
-  case RESULT_ERR_NOTFOUND:
-    result << "404 Not Found";
-    break;
-  case RESULT_ERR_INVALID_ARG:
-  case RESULT_ERR_INVALID_NUM:
-  case RESULT_ERR_OUT_OF_RANGE:
-    result << "400 Bad Request";
-    break;
-  case RESULT_ERR_NOTAUTHORIZED:
-    result << "403 Forbidden";
-    break;
-  default:
-    result << "500 Internal Server Error";
-    break;
+  appendHttpHeader(result, ret, type, http11, keepAlive, chunked, stream ? -1 : static_cast<ssize_t>(data.length()),
+      etag);
+  if (!chunked) {
+    result << data;
+    return result.str();
+  }
+  appendHttpChunks(result, data);
+  if (!stream) {
+    result << "0\r\n\r\n";
   }
-  result << "\r\nServer: " PACKAGE_NAME "/" PACKAGE_VERSION "\r\n\r\n";
-  result << data;
   return result.str();
 }
 
+bool MainLoop::sendHttpResultPart(NetMessage* netMessage, ostringstream& result, const string& etag,
+    bool& headerSent, bool& connected) {
+  bool http11 = netMessage->isHttp11();
+  string data = result.str();
+  result.str("");
+  result.clear();
+  if (!headerSent) {
+    if (!http11) {
+      connected = false;  // the end of the body is determined by closing the connection
+    }
+    appendHttpHeader(result, RESULT_OK, 6, http11, connected, http11, -1, etag);
+    headerSent = true;
+  }
+  if (http11) {
+    appendHttpChunks(result, data);
+  } else {
+    result << data;
+  }
+  data = result.str();
+  result.str("");
+  result.clear();
+  if (netMessage->addResultPart(data)) {
+    return true;
+  }
+  logInfo(lf_main, "HTTP client is slow, passing the remaining result at once");
+  return false;
+}
+
 }  // namespace ebusd
@@ -23,6 +23,7 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <utility>
 #include <algorithm>
 #include "ebusd/bushandler.h"
 #include "ebusd/datahandler.h"
@@ -30,6 +31,7 @@
 #include "lib/ebus/filereader.h"
 #include "lib/ebus/message.h"
 #include "lib/utils/rotatefile.h"
+#include "lib/utils/stats.h"
 
 namespace ebusd {
 
@@ -37,6 +39,8 @@ namespace ebusd {
  * The main loop for the TCP client interface and regular tasks such as resolving scanned data.
  */
 
+using std::pair;
+
 /**
  * Helper class for user authentication.
  */
@@ -94,6 +98,50 @@ class UserList : public UserInfo, public MappedFileReader {
 };
 
 
+/**
+ * The pre-rendered labels of a @a Message for the metrics output.
+ */
+class MetricLabels {
+ public:
+  /** the labels identifying the @a Message (circuit and name). */
+  string m_message;
+
+  /** the labels identifying each field in the order of @a Message::decodeLastDataValues(). */
+  vector<string> m_fields;
+};
+
+
+/**
+ * A "readall" command waiting for the @a Message instances to be read from the bus before finishing its @a NetMessage.
+ */
+class ReadAllCommand : public BusRequestListener {
+ public:
+  /**
+   * Constructor.
+   * @param netMessage the @a NetMessage to set the result of when the bus request is finished.
+   * @param verbosity the @a OutputFormat for decoding the read values.
+   */
+  ReadAllCommand(NetMessage* netMessage, const OutputFormat verbosity)
+    : m_netMessage(netMessage), m_verbosity(verbosity) {}
+
+  /**
+   * Destructor.
+   */
+  virtual ~ReadAllCommand() {}
+
+  // @copydoc
+  void notifyFinished(BusRequest* request) override;
+
+
+ private:
+  /** the @a NetMessage to set the result of when the bus request is finished. */
+  NetMessage* m_netMessage;
+
+  /** the @a OutputFormat for decoding the read values. */
+  const OutputFormat m_verbosity;
+};
+
+
 /**
  * The main loop handling requests from connected clients.
  */
@@ -118,6 +166,11 @@ class MainLoop : public Thread, DeviceListener {
    */
   BusHandler* getBusHandler() { return m_busHandler; }
 
+  /**
+   * Request the main loop to end (the thread stops within a few seconds).
+   */
+  void shutdown() { m_shutdown = true; }
+
   /**
    * Add a client @a NetMessage to the queue.
    * @param message the client @a NetMessage to handle.
@@ -137,15 +190,18 @@ class MainLoop : public Thread, DeviceListener {
   /**
    * Decode and execute client message.
    * @param data the data string to decode (may be empty).
+   * @param netMessage the @a NetMessage being handled.
+   * @param updates the changed @a Message instances for a listening HTTP client.
    * @param connected set to false when the client connection shall be closed.
-   * @param isHttp true for HTTP message.
    * @param listening set to true when the client is in listening mode.
    * @param user set to the new user name when changed by authentication.
    * @param reload set to true when the configuration files were reloaded.
+   * @param command set to the name of the executed command with aliases resolved, or empty for an unknown command.
+   * @param deferred set to true when the result is set on the @a NetMessage later on (by a @a BusRequestListener).
    * @return result string to send back to the client.
    */
-  string decodeMessage(const string& data, const bool isHttp, bool& connected, bool& listening,
-      string& user, bool& reload);
+  string decodeMessage(const string& data, NetMessage* netMessage, const deque<Message*>& updates,
+      bool& connected, bool& listening, string& user, bool& reload, string& command, bool& deferred);
 
   /**
    * Parse the hex master message from the remaining arguments.
@@ -181,6 +237,17 @@ class MainLoop : public Thread, DeviceListener {
    */
   string executeRead(vector<string> &args, const string levels);
 
+  /**
+   * Execute the readall command.
+   * @param args the arguments passed to the command (starting with the command itself), or empty for help.
+   * @param levels the current user's access levels.
+   * @param netMessage the @a NetMessage being handled (for sending the cached values before reading the others).
+   * @param deferred set to true when the values are read from the bus and the result is set on @a netMessage when
+   * done.
+   * @return the result string.
+   */
+  string executeReadAll(vector<string> &args, const string levels, NetMessage* netMessage, bool& deferred);
+
   /**
    * Execute the write command.
    * @param args the arguments passed to the command (starting with the command itself), or empty for help.
@@ -270,6 +337,13 @@ class MainLoop : public Thread, DeviceListener {
    */
   string executeInfo(vector<string> &args, const string user);
 
+  /**
+   * Execute the stats command.
+   * @param args the arguments passed to the command (starting with the command itself), or empty for help.
+   * @return the result string.
+   */
+  string executeStats(vector<string> &args);
+
   /**
    * Execute the quit command.
    * @param args the arguments passed to the command (starting with the command itself), or empty for help.
@@ -287,19 +361,62 @@ class MainLoop : public Thread, DeviceListener {
   /**
    * Execute the HTTP GET command.
    * @param args the arguments passed to the command (starting with the command itself).
-   * @param connected set to false when the client connection shall be closed.
+   * @param netMessage the @a NetMessage being handled (for sending large results in parts).
+   * @param updates the changed @a Message instances to send to a streaming client.
+   * @param connected true when the client requested a persistent connection, set to false when the client
+   * connection shall be closed.
+   * @param listening true when the client is already streaming updates, set to true when the client starts
+   * streaming.
    * @return the result string.
    */
-  string executeGet(vector<string> &args, bool& connected);
+  string executeGet(vector<string> &args, NetMessage* netMessage, const deque<Message*>& updates,
+      bool& connected, bool& listening);
+
+  /**
+   * Format the bus and message metrics in the Prometheus text exposition format.
+   * @param output the @a ostringstream to format the metrics to.
+   */
+  void formatMetrics(ostringstream& output);
+
+  /**
+   * Collect the CPU time consumed by each of the threads.
+   * @param times the list to add the pairs of thread name and consumed CPU time in microseconds to.
+   */
+  void getCpuTimes(vector<pair<string, uint64_t>>& times);
+
+  /**
+   * Format the CPU time and latency statistics with one line per value.
+   * @param output the @a ostringstream to format the statistics to.
+   * @param full true to include the execution times of the client commands.
+   */
+  void formatStats(ostringstream& output, bool full);
 
   /**
    * Format the HTTP answer to the result string.
-   * @param ret the result code of handling the request.
+   * @param ret the result code of handling the request (@a RESULT_EMPTY for not modified).
    * @param result the @a ostringstream containing the successful result.
-   * @param type the content type.
+   * @param type the content type (7 for a stream of server-sent events in @p result).
+   * @param http11 true when the HTTP client uses protocol version 1.1 (allows chunked transfer encoding).
+   * @param keepAlive true when the connection is kept open after the response.
+   * @param etag the entity tag of the result, or empty.
    * @return the result string.
    */
-  string formatHttpResult(result_t ret, ostringstream& result, int type);
+  string formatHttpResult(result_t ret, ostringstream& result, int type, const bool http11, const bool keepAlive,
+      const string& etag = "");
+
+  /**
+   * Send the JSON result collected so far as part of the HTTP answer, preceded by the header for the first part.
+   * @param netMessage the @a NetMessage to add the result part to.
+   * @param result the @a ostringstream containing the result so far (cleared afterwards).
+   * @param etag the entity tag of the result, or empty.
+   * @param headerSent whether the header was already sent, set to true afterwards.
+   * @param connected true when the connection is kept open after the response, set to false when the client
+   * connection shall be closed.
+   * @return true when further parts may be sent, false when the client is slow and the remaining result shall be
+   * returned at once.
+   */
+  bool sendHttpResultPart(NetMessage* netMessage, ostringstream& result, const string& etag, bool& headerSent,
+      bool& connected);
 
   /** the @a Device instance. */
   Device* m_device;
@@ -307,6 +424,9 @@ class MainLoop : public Thread, DeviceListener {
   /** the number of reconnects requested from the @a Device. */
   unsigned int m_reconnectCount;
 
+  /** whether the main loop shall end. */
+  bool m_shutdown;
+
   /** the @a RotateFile for writing sent/received bytes in log format, or NULL. */
   RotateFile* m_logRawFile;
 
@@ -341,8 +461,8 @@ class MainLoop : public Thread, DeviceListener {
   /** the created @a Network instance. */
   Network* m_network;
 
-  /** the @a NetMessage @a Queue. */
-  Queue<NetMessage*> m_netQueue;
+  /** the @a NetMessage @a LinkedQueue. */
+  LinkedQueue<NetMessage> m_netQueue;
 
   /** the path for HTML files served by the HTTP port. */
   string m_htmlPath;
@@ -352,6 +472,12 @@ class MainLoop : public Thread, DeviceListener {
 
   /** the result of the last update check, or empty. */
   string m_updateCheck;
+
+  /** the pre-rendered @a MetricLabels by @a Message (cleared when reloading the configuration). */
+  map<const Message*, MetricLabels> m_metricLabels;
+
+  /** the execution times of the client commands by command name. */
+  map<string, LatencyHistogram> m_commandStats;
 };
 
 }  // namespace ebusd
@@ -21,12 +21,15 @@
 #endif
 
 #include "ebusd/mqtthandler.h"
+#include <unistd.h>
 #include <csignal>
+#include <deque>
 #include "lib/utils/log.h"
 
 namespace ebusd {
 
 using std::dec;
+using std::deque;
 
 /** the definition of the MQTT arguments. */
 static const struct argp_option g_mqtt_argp_options[] = {
@@ -36,6 +39,9 @@ static const struct argp_option g_mqtt_argp_options[] = {
   {"mqttuser",    3, "USER",     0, "Connect as USER to MQTT broker (no default)", 0 },
   {"mqttpass",    4, "PASSWORD", 0, "Use PASSWORD when connecting to MQTT broker (no default)", 0 },
   {"mqtttopic",   5, "TOPIC",    0, "Use MQTT TOPIC (prefix before /%circuit/%name or complete format) [ebusd]", 0 },
+  {"mqttrate",   10, "COUNT",    0, "Publish at most COUNT updates per second to MQTT broker, 0 for no limit [0]", 0 },
+  {"mqttspool",  11, "FILE",     0, "Spool updates to FILE while MQTT broker is unreachable (no default)", 0 },
+  {"mqttdiscovery", 12, "PREFIX", 0, "Publish Home Assistant MQTT discovery configs under PREFIX (no default)", 0 },
 
 #if (LIBMOSQUITTO_MAJOR >= 1)
   {"mqttca",      6, "CA",       0, "Use CA file or dir (ending with '/') for MQTT TLS (no default)", 0 },
@@ -52,6 +58,12 @@ static uint16_t g_port = 0;               //!< optional port of MQTT broker, 0 t
 static const char* g_username = NULL;     //!< optional user name for MQTT broker (no default)
 static const char* g_password = NULL;     //!< optional password for MQTT broker (no default)
 static const char* g_topic = PACKAGE;     //!< MQTT topic to use (prefix if without wildcards) [ebusd]
+static unsigned int g_rate = 0;           //!< maximum topic updates per second, 0 for no limit [0]
+static const char* g_spoolFile = NULL;    //!< optional file for spooling updates while disconnected (no default)
+static const char* g_discoveryPrefix = NULL;  //!< optional Home Assistant discovery topic prefix (no default)
+
+/** the maximum size of the spool file in bytes. */
+#define MAX_SPOOL_SIZE (16*1024*1024)
 
 #if (LIBMOSQUITTO_MAJOR >= 1)
 static const char* g_cafile = NULL;    //!< CA file for TLS
@@ -112,6 +124,30 @@ static error_t mqtt_parse_opt(int key, char *arg, struct argp_state *state) {
     g_topic = arg;
     break;
 
+  case 10:  // --mqttrate=0
+    g_rate = parseInt(arg, 10, 0, 100000, result);
+    if (result != RESULT_OK) {
+      argp_error(state, "invalid mqttrate");
+      return EINVAL;
+    }
+    break;
+
+  case 11:  // --mqttspool=FILE
+    if (arg == NULL || arg[0] == 0) {
+      argp_error(state, "invalid mqttspool");
+      return EINVAL;
+    }
+    g_spoolFile = arg;
+    break;
+
+  case 12:  // --mqttdiscovery=homeassistant
+    if (arg == NULL || arg[0] == 0 || strchr(arg, '#') || strchr(arg, '+') || arg[strlen(arg)-1] == '/') {
+      argp_error(state, "invalid mqttdiscovery");
+      return EINVAL;
+    }
+    g_discoveryPrefix = arg;
+    break;
+
 #if (LIBMOSQUITTO_MAJOR >= 1)
     case 6:  // --mqttca=file or --mqttca=dir/
       if (arg == NULL || arg[0] == 0) {
@@ -242,6 +278,10 @@ void on_connect(
   void *obj, int rc) {
   if (rc == 0) {
     logOtherNotice("mqtt", "connection established");
+    MqttHandler* handler = reinterpret_cast<MqttHandler*>(obj);
+    if (handler) {
+      handler->notifyConnection(true);
+    }
   } else {
     if (rc >= 1 && rc <= 3) {
       logOtherError("mqtt", "connection refused: %s",
@@ -252,10 +292,30 @@ void on_connect(
   }
 }
 
+#if (LIBMOSQUITTO_MAJOR >= 1)
+void on_disconnect(struct mosquitto *mosq, void *obj, int rc) {
+  if (rc != 0) {
+    logOtherError("mqtt", "connection lost");
+  }
+  MqttHandler* handler = reinterpret_cast<MqttHandler*>(obj);
+  if (handler) {
+    handler->notifyConnection(false);
+  }
+}
+#endif
+
+
+void MqttCommand::notifyFinished(BusRequest* request) {
+  m_request = dynamic_cast<MultiReadRequest*>(request);
+  m_queue->push(this);
+}
+
 
 MqttHandler::MqttHandler(UserInfo* userInfo, BusHandler* busHandler, MessageMap* messages)
   : DataSink(userInfo, "mqtt"), DataSource(busHandler), Thread(), m_messages(messages), m_connected(false),
-    m_lastUpdateCheckResult(".") {
+    m_reconnected(false), m_activeCommands(0), m_lastUpdateCheckResult("."), m_commandTopicsSize(0),
+    m_publishAllowance(g_rate), m_lastAllowanceTime(0), m_spoolFile(NULL), m_spoolReadPos(0), m_spoolSize(0),
+    m_spoolFull(false) {
   bool enabled = g_port != 0;
   m_publishByField = false;
   m_mosquitto = NULL;
@@ -342,6 +402,9 @@ MqttHandler::MqttHandler(UserInfo* userInfo, BusHandler* busHandler, MessageMap*
 #endif
 
     mosquitto_connect_callback_set(m_mosquitto, on_connect);
+#if (LIBMOSQUITTO_MAJOR >= 1)
+    mosquitto_disconnect_callback_set(m_mosquitto, on_disconnect);
+#endif
 #if (LIBMOSQUITTO_MAJOR >= 1)
     if (mosquitto_connect(m_mosquitto, g_host, g_port, 60) != MOSQ_ERR_SUCCESS) {
 #else
@@ -355,10 +418,23 @@ MqttHandler::MqttHandler(UserInfo* userInfo, BusHandler* busHandler, MessageMap*
       logOtherDebug("mqtt", "connection requested");
     }
   }
+  if (m_mosquitto && g_spoolFile) {
+    m_spoolFile = fopen(g_spoolFile, "a+b");  // updates left from a previous run are published after connecting
+    if (m_spoolFile) {
+      fseek(m_spoolFile, 0, SEEK_END);
+      m_spoolSize = ftell(m_spoolFile);
+    } else {
+      logOtherError("mqtt", "unable to open spool file %s", g_spoolFile);
+    }
+  }
 }
 
 MqttHandler::~MqttHandler() {
   join();
+  if (m_spoolFile) {
+    fclose(m_spoolFile);
+    m_spoolFile = NULL;
+  }
   if (m_mosquitto) {
     mosquitto_destroy(m_mosquitto);
     m_mosquitto = NULL;
@@ -386,87 +462,254 @@ void on_message(
   handler->notifyTopic(topic, data);
 }
 
-void MqttHandler::notifyTopic(string topic, string data) {
-  size_t pos = topic.rfind('/');
-  if (pos == string::npos) {
-    return;
+void MqttHandler::notifyTopic(const string& topic, const string& data) {
+  m_commands.push(new MqttCommand(&m_commands, topic, data));
+}
+
+void MqttHandler::notifyConnection(bool connected) {
+  m_connected = connected;
+  if (connected) {
+    string subTopic = getTopic(NULL)+"#";
+    mosquitto_subscribe(m_mosquitto, NULL, subTopic.c_str(), 0);
+    m_reconnected = true;
   }
-  string direction = topic.substr(pos+1);
-  bool isWrite = false;
-  if (direction.empty()) {
-    return;
+}
+
+void MqttHandler::handleCommands(int timeout) {
+  MqttCommand* command;
+  while ((command = m_commands.pop(timeout)) != NULL) {
+    timeout = 0;  // handle all others available without waiting
+    if (command->m_request) {
+      finishCommand(command);
+    } else {
+      startCommand(command);
+    }
   }
-  isWrite = direction == "set";
-  if (!isWrite && direction != "get") {
+}
+
+void MqttHandler::startCommand(MqttCommand* command) {
+  checkMessages();
+  if (m_commandTopicsSize != m_messages->size()) {
+    buildCommandTopics();
+  }
+  unordered_map<string, pair<Message*, bool>>::const_iterator it = m_commandTopics.find(command->m_topic);
+  if (it == m_commandTopics.end()) {
+    delete command;  // not a command topic, e.g. one published by ourselves
     return;
   }
-
-  logOtherDebug("mqtt", "received topic %s", topic.c_str(), data.c_str());
-  string remain = topic.substr(0, pos);
-  size_t last = 0;
-  string circuit, name;
-  size_t idx;
-  for (idx = 0; idx < m_topicStrs.size()+1; idx++) {
-    string field;
-    string chk;
-    if (idx < m_topicStrs.size()) {
-      chk = m_topicStrs[idx];
-      pos = remain.find(chk, last);
-      if (pos == string::npos) {
-        return;
-      }
-    } else if (idx-1 < m_topicFields.size()) {
-      pos = remain.size();
-    } else if (last < remain.size()) {
+  logOtherDebug("mqtt", "received topic %s", command->m_topic.c_str());
+  Message* message = it->second.first;
+  bool isWrite = it->second.second;
+  string circuit = message->getCircuit(), name = message->getName();
+  logOtherInfo("mqtt", "received topic for %s %s", circuit.c_str(), name.c_str());
+  if (message->isConditional()) {
+    // the available one of several conditional messages might have changed
+    message = m_messages->find(circuit, name, m_levels, isWrite);
+    if (message == NULL) {
+      message = m_messages->find(circuit, name, m_levels, isWrite, true);
+    }
+    if (message == NULL) {
+      logOtherError("mqtt", "%s message %s %s not found", isWrite?"write":"read", circuit.c_str(), name.c_str());
+      delete command;
       return;
-    } else {
-      break;
     }
-    field = remain.substr(last, pos-last);
-    last = pos+chk.size();
-    if (idx == 0) {
-      if (pos > 0) {
-        return;
+  }
+  if (message->isPassive()) {
+    ostringstream ostream;
+    publishMessage(message, ostream, true);
+    publishPending();
+    delete command;
+    return;
+  }
+  command->m_isWrite = isWrite;
+  deque<Message*> messages;
+  messages.push_back(message);
+  m_activeCommands++;
+  m_busHandler->startRead(messages, command, command->m_data);  // finishCommand() is called when done
+}
+
+void MqttHandler::finishCommand(MqttCommand* command) {
+  m_activeCommands--;
+  result_t result = RESULT_EMPTY;
+  Message* message = command->m_request->waitForNext(&result);  // already finished
+  const char* type = command->m_isWrite ? "write" : "read";
+  if (result != RESULT_OK) {
+    logOtherError("mqtt", "%s %s %s: %s", type, message->getCircuit().c_str(), message->getName().c_str(),
+        getResultCode(result));
+  } else {
+    logOtherNotice("mqtt", "%s %s %s: %s", type, message->getCircuit().c_str(), message->getName().c_str(),
+        command->m_data.c_str());
+    ostringstream ostream;
+    publishMessage(message, ostream, true);
+    publishPending();
+  }
+  delete command->m_request;
+  delete command;
+}
+
+void MqttHandler::checkMessages() {
+  if (checkReloaded()) {
+    m_messageTopics.clear();
+    m_commandTopics.clear();
+    m_commandTopicsSize = 0;
+  }
+}
+
+void MqttHandler::buildCommandTopics() {
+  m_commandTopics.clear();
+  deque<Message*> messages = m_messages->findAll("", "", m_levels, true, true, true, true, true, false);
+  for (const auto message : messages) {
+    size_t count = m_publishByField ? message->getFieldCount() : 1;
+    for (size_t index = 0; index < count; index++) {
+      const string& topic = getCachedTopic(message, index);
+      if (message->isPassive() || !message->isWrite()) {
+        addCommandTopic(topic+"/get", message, false);
       }
-    } else {
-      if (field.empty()) {
-        return;
+      if (message->isPassive() || message->isWrite()) {
+        addCommandTopic(topic+"/set", message, true);
       }
-      string fieldName = m_topicFields[idx-1];
-      if (fieldName == "circuit") {
-        circuit = field;
-      } else if (fieldName == "name") {
-        name = field;
-      } else if (fieldName == "fields") {
-        // field = field;  // TODO add support for writing a single field
-      } else {
-        return;
+    }
+  }
+  m_commandTopicsSize = m_messages->size();
+  logOtherDebug("mqtt", "built %d command topics", static_cast<int>(m_commandTopics.size()));
+  if (g_discoveryPrefix) {
+    m_discoveryConfigs.clear();
+    for (const auto message : messages) {
+      if (message->isPassive() || !message->isWrite()) {
+        buildDiscoveryConfigs(message);
       }
     }
+    for (const auto& it : m_discoveryConfigs) {
+      publishChanged(it.first, it.second);  // only the changed ones are sent again
+    }
   }
-  if (circuit.empty() || name.empty()) {
-    return;
+}
+
+/**
+ * Replace all characters not allowed in a Home Assistant object ID.
+ * @param str the string to convert.
+ * @return the string with all characters other than letters, digits, '_', and '-' replaced by '_'.
+ */
+static string getObjectId(const string& str) {
+  string ret = str;
+  for (auto& ch : ret) {
+    if (!((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '-')) {
+      ch = '_';
+    }
   }
-  logOtherInfo("mqtt", "received topic for %s %s", circuit.c_str(), name.c_str());
-  Message* message = m_messages->find(circuit, name, m_levels, isWrite);
-  if (message == NULL) {
-    message = m_messages->find(circuit, name, m_levels, isWrite, true);
+  return ret;
+}
+
+/**
+ * Get the decoded value of a raw numeric value.
+ * @param type the @a NumberDataType.
+ * @param value the raw value.
+ * @return the decoded value.
+ */
+static double getNumberValue(const NumberDataType* type, unsigned int value) {
+  double ret = value;
+  size_t bitCount = type->getBitCount();
+  if (type->hasFlag(SIG) && (value & (1u << (bitCount-1))) != 0) {
+    ret -= static_cast<double>(1ULL << bitCount);
   }
-  if (message == NULL) {
-    logOtherError("mqtt", "%s message %s %s not found", isWrite?"write":"read", circuit.c_str(), name.c_str());
-    return;
+  int divisor = type->getDivisor();
+  if (divisor > 1) {
+    ret /= divisor;
+  } else if (divisor < 0) {
+    ret *= -divisor;
   }
-  if (!message->isPassive()) {
-    result_t result = m_busHandler->readFromBus(message, data);
-    if (result != RESULT_OK) {
-      logOtherError("mqtt", "%s %s %s: %s", isWrite?"write":"read", circuit.c_str(), name.c_str(),
-          getResultCode(result));
-      return;
+  return ret;
+}
+
+void MqttHandler::buildDiscoveryConfigs(Message* message) {
+  const string circuit = message->getCircuit(), name = message->getName();
+  if (message->isPassive() && m_messages->find(circuit, name, m_levels, false)) {
+    return;  // the active one is used
+  }
+  size_t valueCount = 0;
+  for (size_t index = 0; index < message->getFieldCount(); index++) {
+    const SingleDataField* field = message->getField(index);
+    if (field && !field->isIgnored()) {
+      valueCount++;
     }
-    logOtherNotice("mqtt", "%s %s %s: %s", isWrite?"write":"read", circuit.c_str(), name.c_str(), data.c_str());
   }
-  ostringstream ostream;
-  publishMessage(message, ostream);
+  // writable if the write message has a single field as well
+  Message* writeMessage = NULL;
+  if (valueCount == 1 && !message->isPassive()) {
+    writeMessage = m_messages->find(circuit, name, m_levels, true);
+    size_t writeCount = 0;
+    for (size_t index = 0; writeMessage && index < writeMessage->getFieldCount(); index++) {
+      const SingleDataField* field = writeMessage->getField(index);
+      if (field && !field->isIgnored()) {
+        writeCount++;
+      }
+    }
+    if (writeCount != 1) {
+      writeMessage = NULL;
+    }
+  }
+  ostringstream config;
+  size_t valueIndex = 0;
+  for (size_t index = 0; index < message->getFieldCount(); index++) {
+    const SingleDataField* field = message->getField(index);
+    if (!field || field->isIgnored()) {
+      continue;
+    }
+    string objectId = getObjectId(circuit+"_"+name+(valueCount > 1 ? "_"+field->getName() : ""));
+    const ValueListDataField* valueList = dynamic_cast<const ValueListDataField*>(field);
+    bool numeric = !valueList && field->getDataType()->isNumeric();
+    const char* component = writeMessage ? (valueList ? "select" : (numeric ? "number" : "text")) : "sensor";
+    config.str("");
+    config << "{";
+    AttributedItem::appendJson(config, "unique_id", PACKAGE "_"+objectId, false, true);
+    AttributedItem::appendJson(config, "name", valueCount > 1 ? name+" "+field->getName() : name, true, true);
+    AttributedItem::appendJson(config, "state_topic", getCachedTopic(message, m_publishByField ? valueIndex : 0),
+        true, true);
+    if (!m_publishByField && valueCount > 1) {
+      ostringstream tmpl;
+      tmpl << "{{ value.split('" << UI_FIELD_SEPARATOR << "')[" << valueIndex << "] }}";
+      AttributedItem::appendJson(config, "value_template", tmpl.str(), true, true);
+    }
+    string unit = field->getAttribute("unit");
+    if (!unit.empty() && !valueList) {
+      AttributedItem::appendJson(config, "unit_of_measurement", unit, true, true);
+    }
+    if (writeMessage) {
+      AttributedItem::appendJson(config, "command_topic", getCachedTopic(writeMessage, 0)+"/set", true, true);
+    }
+    if (writeMessage && valueList) {
+      config << ", \"options\": [";
+      for (const auto& it : valueList->getValues()) {
+        if (it.first != valueList->getValues().begin()->first) {
+          config << ", ";
+        }
+        appendJsonString(config, it.second);
+      }
+      config << "]";
+    } else if (writeMessage && numeric) {
+      const NumberDataType* type = static_cast<const NumberDataType*>(field->getDataType());
+      double min = getNumberValue(type, type->getMinValue()), max = getNumberValue(type, type->getMaxValue());
+      config << ", \"min\": " << (min < max ? min : max) << ", \"max\": " << (min < max ? max : min)
+             << ", \"step\": " << (type->getDivisor() > 1 ? 1.0 / type->getDivisor() : 1.0) << ", \"mode\": \"box\"";
+    }
+    AttributedItem::appendJson(config, "availability_topic", m_globalTopic+"running", true, true);
+    AttributedItem::appendJson(config, "payload_available", "true", true, true);
+    AttributedItem::appendJson(config, "payload_not_available", "false", true, true);
+    config << ", \"device\": {";
+    AttributedItem::appendJson(config, "identifiers", PACKAGE "_"+getObjectId(circuit), false, true);
+    AttributedItem::appendJson(config, "name", PACKAGE " "+circuit, true, true);
+    config << "}}";
+    m_discoveryConfigs[string(g_discoveryPrefix)+"/"+component+"/"+PACKAGE+"/"+objectId+"/config"] = config.str();
+    valueIndex++;
+  }
+}
+
+void MqttHandler::addCommandTopic(const string& topic, Message* message, bool isWrite) {
+  pair<Message*, bool>& entry = m_commandTopics[topic];
+  if (entry.first == NULL || (entry.first->isPassive() && !message->isPassive())) {
+    entry.first = message;
+    entry.second = isWrite;
+  }
 }
 
 void MqttHandler::notifyUpdateCheckResult(string checkResult) {
@@ -482,17 +725,37 @@ void MqttHandler::run() {
   string signalTopic = m_globalTopic+"signal";
   string uptimeTopic = m_globalTopic+"uptime";
   ostringstream updates;
+  map<Message*, int> updatedMessages;
 
   time(&now);
   start = lastTaskRun = now;
-  publishTopic(m_globalTopic+"version", PACKAGE_STRING "." REVISION);
-  publishTopic(m_globalTopic+"running", "true");
-  publishTopic(signalTopic, "false");
+  publishChanged(m_globalTopic+"version", PACKAGE_STRING "." REVISION);
+  publishChanged(m_globalTopic+"running", "true");
+  publishChanged(signalTopic, "false");
   mosquitto_message_callback_set(m_mosquitto, on_message);
-  string subTopic = getTopic(NULL)+"#";
-  mosquitto_subscribe(m_mosquitto, NULL, subTopic.c_str(), 0);
+#if (LIBMOSQUITTO_MAJOR >= 1)
+  // let the broker I/O run in a separate thread so that a slow broker does not stall the updates and vice versa
+  bool threaded = mosquitto_loop_start(m_mosquitto) == MOSQ_ERR_SUCCESS;
+  if (!threaded) {
+    logOtherError("mqtt", "unable to start network thread");
+  }
+#else
+  bool threaded = false;
+#endif
   while (isRunning()) {
-    handleTraffic();
+    if (threaded) {
+      handleCommands(1);
+    } else {
+      handleTraffic();
+      handleCommands(0);
+    }
+    if (m_reconnected.exchange(false)) {
+      m_publishedValues.clear();  // the broker might have lost the retained values
+      publishChanged(m_globalTopic+"running", "true");
+      for (const auto& it : m_discoveryConfigs) {
+        publishChanged(it.first, it.second);
+      }
+    }
     time(&now);
     if (now < start) {
       // clock skew
@@ -505,32 +768,56 @@ void MqttHandler::run() {
         lastSignal = now;
         if (!signal) {
           signal = true;
-          publishTopic(signalTopic, "true");
+          publishChanged(signalTopic, "true");
         }
       } else {
         if (signal) {
           signal = false;
-          publishTopic(signalTopic, "false");
+          publishChanged(signalTopic, "false");
         }
       }
       time_t uptime = now-start;
       updates.str("");
       updates.clear();
       updates << dec << static_cast<unsigned>(uptime);
-      publishTopic(uptimeTopic, updates.str());
+      publishChanged(uptimeTopic, updates.str());
       time(&lastTaskRun);
     }
-    if (m_connected && !m_updatedMessages.empty()) {
-      for (map<Message*, int>::iterator it = m_updatedMessages.begin(); it != m_updatedMessages.end(); it++) {
-        Message* message = it->first;
-        updates.str("");
-        updates.clear();
-        updates << dec;
-        publishMessage(message, updates);
-      }
+    checkMessages();
+    if (m_commandTopicsSize != m_messages->size()) {
+      buildCommandTopics();
+    }
+    uint64_t updatedSince = takeUpdatedMessages(updatedMessages);
+    for (map<Message*, int>::iterator it = updatedMessages.begin(); it != updatedMessages.end(); it++) {
+      Message* message = it->first;
+      updates.str("");
+      updates.clear();
+      updates << dec;
+      publishMessage(message, updates);
+    }
+    publishPending();
+    if (updatedSince) {
+      m_publishStats.addSince(updatedSince);
     }
-    m_updatedMessages.clear();
   }
+  // the bus handler was stopped before and notified all requests it had, so only finish the ones notified already
+  // (a request started afterwards is never notified and is left in the queue of the stopped bus handler)
+  MqttCommand* command;
+  while ((command = m_commands.pop()) != NULL) {
+    if (command->m_request) {
+      finishCommand(command);
+    } else {
+      delete command;
+    }
+  }
+  if (m_activeCommands > 0) {
+    logOtherNotice("mqtt", "%d commands not finished", static_cast<int>(m_activeCommands));
+  }
+#if (LIBMOSQUITTO_MAJOR >= 1)
+  if (threaded) {
+    mosquitto_loop_stop(m_mosquitto, true);
+  }
+#endif
 }
 
 void MqttHandler::handleTraffic() {
@@ -543,6 +830,7 @@ void MqttHandler::handleTraffic() {
 #endif
     if (!m_connected && ret == MOSQ_ERR_SUCCESS) {
       m_connected = true;
+      m_reconnected = true;
       logOtherNotice("mqtt", "connection re-established");
     }
     if (!m_connected || ret == MOSQ_ERR_SUCCESS) {
@@ -576,31 +864,161 @@ string MqttHandler::getTopic(Message* message, ssize_t fieldIndex) {
   return ret.str();
 }
 
-void MqttHandler::publishMessage(Message* message, ostringstream& updates) {
+const string& MqttHandler::getCachedTopic(Message* message, size_t fieldIndex) {
+  vector<string>& topics = m_messageTopics[message];
+  while (topics.size() <= fieldIndex) {
+    topics.push_back(getTopic(message, m_publishByField ? static_cast<ssize_t>(topics.size()) : -1));
+  }
+  return topics[fieldIndex];
+}
+
+void MqttHandler::publishMessage(Message* message, ostringstream& updates, bool force) {
   result_t result = message->decodeLastData(updates);
   if (result != RESULT_OK) {
     logOtherError("mqtt", "decode %s %s: %s", message->getCircuit().c_str(), message->getName().c_str(),
         getResultCode(result));
     return;
   }
-  if (m_publishByField) {
-    ssize_t index = 0;
-    istringstream input(updates.str());
-    string token;
-    while (getline(input, token, UI_FIELD_SEPARATOR)) {
-      string topic = getTopic(message, index);
-      publishTopic(topic, token);
-      index++;
+  const string str = updates.str();
+  if (!m_publishByField) {
+    publishChanged(getCachedTopic(message, 0), str, force);
+    return;
+  }
+  size_t index = 0;
+  for (size_t pos = 0; pos < str.length(); index++) {
+    size_t end = str.find(UI_FIELD_SEPARATOR, pos);
+    if (end == string::npos) {
+      end = str.length();
+    }
+    publishChanged(getCachedTopic(message, index), str.substr(pos, end-pos), force);
+    pos = end+1;
+  }
+}
+
+void MqttHandler::publishChanged(const string& topic, const string& data, bool force) {
+  map<string, string>::iterator it = m_outboundValues.find(topic);
+  if (it != m_outboundValues.end()) {
+    if (it->second != data) {
+      if (m_spoolFile && !m_connected) {
+        spoolTopic(topic, it->second);  // keep the replaced update for publishing later
+      }
+      it->second = data;
+    }
+    return;
+  }
+  if (!force) {
+    it = m_publishedValues.find(topic);
+    if (it != m_publishedValues.end() && it->second == data) {
+      return;  // unchanged
     }
-  } else {
-    publishTopic(getTopic(message), updates.str());
   }
+  m_outboundValues[topic] = data;
+  m_outboundTopics.push_back(topic);
 }
 
-void MqttHandler::publishTopic(string topic, string data, bool retain) {
+void MqttHandler::publishPending() {
+  if (!m_connected || (m_outboundTopics.empty() && m_spoolReadPos >= m_spoolSize)) {
+    return;
+  }
+  if (g_rate > 0) {
+    time_t now;
+    time(&now);
+    if (now < m_lastAllowanceTime) {
+      m_lastAllowanceTime = now;  // clock skew
+    } else if (now > m_lastAllowanceTime) {
+      // at least one second passed, which refills the allowance up to its maximum of one second anyway (also
+      // without multiplying the elapsed seconds that might overflow, e.g. for the initial time 0)
+      m_publishAllowance = g_rate;
+      m_lastAllowanceTime = now;
+    }
+  }
+  size_t count = 0;
+  string topic, data;
+  while (m_spoolFile && (g_rate == 0 || m_publishAllowance > 0)) {
+    long pos = m_spoolReadPos;
+    if (!readSpooledTopic(topic, data)) {
+      break;
+    }
+    if (!publishTopic(topic, data, false, 1)) {
+      m_spoolReadPos = pos;  // try again later
+      return;
+    }
+    count++;
+    if (g_rate > 0) {
+      m_publishAllowance--;
+    }
+  }
+  while (!m_outboundTopics.empty() && (g_rate == 0 || m_publishAllowance > 0)) {
+    map<string, string>::iterator it = m_outboundValues.find(m_outboundTopics.front());
+    if (!publishTopic(it->first, it->second)) {
+      break;  // try again later
+    }
+    m_publishedValues[it->first] = it->second;
+    m_outboundValues.erase(it);
+    m_outboundTopics.pop_front();
+    count++;
+    if (g_rate > 0) {
+      m_publishAllowance--;
+    }
+  }
+  if (count > 0) {
+    logOtherDebug("mqtt", "published %d topics, %d remaining", static_cast<int>(count),
+        static_cast<int>(m_outboundTopics.size()));
+  }
+}
+
+void MqttHandler::spoolTopic(const string& topic, const string& data) {
+  if (m_spoolSize >= MAX_SPOOL_SIZE) {
+    if (!m_spoolFull) {
+      logOtherError("mqtt", "spool file full");
+      m_spoolFull = true;  // log only once until truncated
+    }
+    return;
+  }
+  fseek(m_spoolFile, 0, SEEK_END);  // needed when switching from reading to writing
+  fprintf(m_spoolFile, "%u %u\n", static_cast<unsigned>(topic.length()), static_cast<unsigned>(data.length()));
+  fwrite(topic.c_str(), 1, topic.length(), m_spoolFile);
+  fwrite(data.c_str(), 1, data.length(), m_spoolFile);
+  fputc('\n', m_spoolFile);
+  fflush(m_spoolFile);
+  m_spoolSize = ftell(m_spoolFile);
+}
+
+bool MqttHandler::readSpooledTopic(string& topic, string& data) {
+  if (m_spoolReadPos < m_spoolSize && fseek(m_spoolFile, m_spoolReadPos, SEEK_SET) == 0) {
+    char line[32];
+    unsigned int topicLength, dataLength;
+    if (fgets(line, sizeof(line), m_spoolFile) && sscanf(line, "%u %u", &topicLength, &dataLength) == 2
+        && topicLength > 0 && topicLength + dataLength < MAX_SPOOL_SIZE) {
+      topic.resize(topicLength);
+      data.resize(dataLength);
+      if (fread(&topic[0], 1, topicLength, m_spoolFile) == topicLength
+          && (dataLength == 0 || fread(&data[0], 1, dataLength, m_spoolFile) == dataLength)
+          && fgetc(m_spoolFile) == '\n') {
+        m_spoolReadPos = ftell(m_spoolFile);
+        return true;
+      }
+    }
+    logOtherError("mqtt", "invalid spool file content skipped");
+  }
+  // completely read (or invalid): start over with an empty file
+  if (m_spoolSize > 0 && ftruncate(fileno(m_spoolFile), 0) != 0) {
+    logOtherError("mqtt", "unable to truncate spool file");
+  }
+  m_spoolReadPos = m_spoolSize = 0;
+  m_spoolFull = false;
+  return false;
+}
+
+bool MqttHandler::publishTopic(const string& topic, const string& data, bool retain, int qos) {
   logOtherDebug("mqtt", "publish %s %s", topic.c_str(), data.c_str());
-  mosquitto_publish(m_mosquitto, NULL, topic.c_str(), (uint32_t)data.size(),
-      reinterpret_cast<const uint8_t*>(data.c_str()), 0, retain);
+  int ret = mosquitto_publish(m_mosquitto, NULL, topic.c_str(), (uint32_t)data.size(),
+      reinterpret_cast<const uint8_t*>(data.c_str()), qos, retain);
+  if (ret != MOSQ_ERR_SUCCESS) {
+    logOtherDebug("mqtt", "publish %s failed: %d", topic.c_str(), ret);
+    return false;
+  }
+  return true;
 }
 
 }  // namespace ebusd
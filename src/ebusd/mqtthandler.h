@@ -20,12 +20,18 @@
 #define EBUSD_MQTTHANDLER_H_
 
 #include <mosquitto.h>
+#include <atomic>
+#include <cstdio>
+#include <deque>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "ebusd/datahandler.h"
 #include "ebusd/bushandler.h"
 #include "lib/ebus/message.h"
+#include "lib/utils/queue.h"
 
 namespace ebusd {
 
@@ -33,8 +39,11 @@ namespace ebusd {
  * A data handler enabling MQTT support via mosquitto.
  */
 
+using std::deque;
 using std::map;
+using std::pair;
 using std::string;
+using std::unordered_map;
 using std::vector;
 
 /**
@@ -52,6 +61,49 @@ const struct argp_child* mqtthandler_getargs();
  */
 DataHandler* mqtthandler_register(UserInfo* userInfo, BusHandler* busHandler, MessageMap* messages);
 
+/**
+ * An inbound MQTT command passed from the network thread to the @a MqttHandler thread and from there to the bus.
+ */
+class MqttCommand : public BusRequestListener {
+  friend class MqttHandler;
+
+ public:
+  /**
+   * Constructor.
+   * @param queue the @a Queue to add this instance to when the bus request is finished.
+   * @param topic the topic string.
+   * @param data the data string.
+   */
+  MqttCommand(Queue<MqttCommand*>* queue, const string& topic, const string& data)
+    : m_queue(queue), m_topic(topic), m_data(data), m_isWrite(false), m_request(NULL) {}
+
+  /**
+   * Destructor.
+   */
+  virtual ~MqttCommand() {}
+
+  // @copydoc
+  void notifyFinished(BusRequest* request) override;
+
+
+ private:
+  /** the @a Queue to add this instance to when the bus request is finished. */
+  Queue<MqttCommand*>* m_queue;
+
+  /** the topic string. */
+  const string m_topic;
+
+  /** the data string. */
+  const string m_data;
+
+  /** whether the command is for writing the message. */
+  bool m_isWrite;
+
+  /** the finished @a MultiReadRequest, or NULL while not yet sent to the bus. */
+  MultiReadRequest* m_request;
+};
+
+
 /**
  * The main class supporting MQTT data handling.
  */
@@ -74,15 +126,27 @@ class MqttHandler : public DataSink, public DataSource, public Thread {
   void start() override;
 
   /**
-   * Notify the handler of a received MQTT message.
+   * Notify the handler of a received MQTT message (called from the network thread).
    * @param topic the topic string.
    * @param data the data string.
    */
-  void notifyTopic(string topic, string data);
+  void notifyTopic(const string& topic, const string& data);
+
+  /**
+   * Notify the handler of an established or lost connection to the broker (called from the network thread).
+   * @param connected whether the connection was established.
+   */
+  void notifyConnection(bool connected);
 
   // @copydoc
   void notifyUpdateCheckResult(string checkResult) override;
 
+  // @copydoc
+  string getName() const override { return "mqtt"; }
+
+  // @copydoc
+  uint64_t getCpuTime() override { return clockGetCpuMicros(self()); }
+
  protected:
   // @copydoc
   void run() override;
@@ -94,6 +158,48 @@ class MqttHandler : public DataSink, public DataSource, public Thread {
    */
   void handleTraffic();
 
+  /**
+   * Handle the queued inbound commands.
+   * @param timeout the maximum time in seconds to wait for the first command, or 0 for no wait.
+   */
+  void handleCommands(int timeout);
+
+  /**
+   * Route an inbound command to the targeted @a Message and start sending it to the bus.
+   * @param command the @a MqttCommand to start (deleted unless sent to the bus).
+   */
+  void startCommand(MqttCommand* command);
+
+  /**
+   * Publish the result of an inbound command finished on the bus.
+   * @param command the finished @a MqttCommand (deleted afterwards).
+   */
+  void finishCommand(MqttCommand* command);
+
+  /**
+   * Drop the cached topic strings and @a Message references when the configuration was reloaded.
+   */
+  void checkMessages();
+
+  /**
+   * Build the table of inbound command topics and the discovery configs for all accessible @a Message instances.
+   */
+  void buildCommandTopics();
+
+  /**
+   * Build the Home Assistant discovery configs for the fields of a readable @a Message.
+   * @param message the readable @a Message.
+   */
+  void buildDiscoveryConfigs(Message* message);
+
+  /**
+   * Add an inbound command topic to the table, preferring active over passive messages.
+   * @param topic the full topic string including the command suffix.
+   * @param message the @a Message to route the topic to.
+   * @param isWrite whether the topic is for writing the message.
+   */
+  void addCommandTopic(const string& topic, Message* message, bool isWrite);
+
   /**
    * Build the MQTT topic string for the @a Message.
    * @param message the @a Message to build the topic string for.
@@ -103,19 +209,59 @@ class MqttHandler : public DataSink, public DataSource, public Thread {
   string getTopic(Message* message, ssize_t fieldIndex = -1);
 
   /**
-   * Prepare a @a Message and publish as topic.
+   * Get the cached MQTT topic string for the @a Message, building it when first seen.
+   * @param message the @a Message to get the topic string for.
+   * @param fieldIndex the field index for the field column, or 0 when not publishing by field.
+   * @return the cached topic string.
+   */
+  const string& getCachedTopic(Message* message, size_t fieldIndex);
+
+  /**
+   * Prepare a @a Message and add the changed topics to the pending batch.
    * @param message the @a Message to publish.
    * @param updates the @a ostringstream for preparation.
+   * @param force true to add all topics to the pending batch even if unchanged (e.g. for an explicit request).
+   */
+  void publishMessage(Message* message, ostringstream& updates, bool force = false);
+
+  /**
+   * Add a topic update to the outbound queue unless the value was already published. A value still queued for the
+   * same topic is replaced (and spooled when disconnected).
+   * @param topic the topic string.
+   * @param data the data string.
+   * @param force true to add the topic even if the value was already published.
+   */
+  void publishChanged(const string& topic, const string& data, bool force = false);
+
+  /**
+   * Publish the spooled and queued topic updates to MQTT as far as connected and allowed by the drain rate.
+   */
+  void publishPending();
+
+  /**
+   * Append an outdated topic update to the spool file.
+   * @param topic the topic string.
+   * @param data the data string.
+   */
+  void spoolTopic(const string& topic, const string& data);
+
+  /**
+   * Read the next topic update from the spool file and truncate the file when all were read.
+   * @param topic the string to store the topic in.
+   * @param data the string to store the data in.
+   * @return true when a topic update was read, false when the spool file was completely read.
    */
-  void publishMessage(Message* message, ostringstream& updates);
+  bool readSpooledTopic(string& topic, string& data);
 
   /**
    * Publish a topic update to MQTT.
    * @param topic the topic string.
    * @param data the data string.
    * @param retain whether the topic shall be retained.
+   * @param qos the quality of service.
+   * @return true when the update was passed to the broker connection.
    */
-  void publishTopic(string topic, string data, bool retain = true);
+  bool publishTopic(const string& topic, const string& data, bool retain = true, int qos = 0);
 
   /** the @a MessageMap instance. */
   MessageMap* m_messages;
@@ -136,10 +282,58 @@ class MqttHandler : public DataSink, public DataSource, public Thread {
   struct mosquitto* m_mosquitto;
 
   /** whether the connection to the broker is established. */
-  bool m_connected;
+  std::atomic<bool> m_connected;
+
+  /** whether the connection to the broker was (re-)established since the last check by the handler thread. */
+  std::atomic<bool> m_reconnected;
+
+  /** the inbound commands received from the broker or finished on the bus. */
+  Queue<MqttCommand*> m_commands;
+
+  /** the number of inbound commands currently sent to the bus. */
+  size_t m_activeCommands;
 
   /** the last update check result. */
   string m_lastUpdateCheckResult;
+
+  /** the cached topic strings by @a Message (one per field when publishing by field). */
+  map<Message*, vector<string>> m_messageTopics;
+
+  /** the last value published by topic. */
+  map<string, string> m_publishedValues;
+
+  /** the inbound command topics with the routed @a Message and whether it is a write. */
+  unordered_map<string, pair<Message*, bool>> m_commandTopics;
+
+  /** the Home Assistant discovery config by topic (built together with @a m_commandTopics). */
+  map<string, string> m_discoveryConfigs;
+
+  /** the size of the @a MessageMap when @a m_commandTopics was built. */
+  size_t m_commandTopicsSize;
+
+  /** the latest value by topic still to be published (coalescing updates of the same topic). */
+  map<string, string> m_outboundValues;
+
+  /** the topics in @a m_outboundValues in the order to publish them. */
+  deque<string> m_outboundTopics;
+
+  /** the number of topic updates that may be published until the next drain rate interval. */
+  unsigned int m_publishAllowance;
+
+  /** the system time of the last @a m_publishAllowance update. */
+  time_t m_lastAllowanceTime;
+
+  /** the spool file for outdated topic updates, or NULL. */
+  FILE* m_spoolFile;
+
+  /** the position of the next topic update to publish in @a m_spoolFile. */
+  long m_spoolReadPos;
+
+  /** the size of @a m_spoolFile. */
+  long m_spoolSize;
+
+  /** whether @a m_spoolFile reached its maximum size (and this was already logged). */
+  bool m_spoolFull;
 };
 
 }  // namespace ebusd
@@ -25,10 +25,117 @@
 #  include <poll.h>
 #endif
 #include <cstring>
+#include <sstream>
 #include "lib/utils/log.h"
 
 namespace ebusd {
 
+using std::istringstream;
+
+/** the number of seconds after which an idle persistent HTTP connection is closed. */
+#define HTTP_KEEPALIVE_TIMEOUT 15
+
+
+bool NetMessage::add(const string& request) {
+  if (!m_isHttp) {
+    if (request.length() > 0) {
+      size_t start = m_request.length();
+      m_request.append(request);
+      m_request.erase(remove(m_request.begin()+start, m_request.end(), '\r'), m_request.end());
+    }
+    size_t pos = m_request.find('\n');
+    if (pos != string::npos) {
+      if (pos+1 == m_request.length()) {
+        m_request.resize(pos);  // reduce to complete lines
+      }
+      return true;
+    }
+    return m_request.length() == 0 && m_listening;
+  }
+  m_pending.append(request);
+  if (m_pendingBodySize > 0) {
+    // the body of the previous request is not used
+    size_t skip = m_pendingBodySize < m_pending.length() ? m_pendingBodySize : m_pending.length();
+    m_pending.erase(0, skip);
+    m_pendingBodySize -= skip;
+    if (m_pendingBodySize > 0) {
+      return false;
+    }
+  }
+  // find the empty line terminating the headers (the body is counted in raw bytes, so keep any CR up to there)
+  size_t end = string::npos;
+  for (size_t pos = m_pending.find('\n'); pos != string::npos; pos = m_pending.find('\n', pos+1)) {
+    size_t next = pos+1;
+    if (next < m_pending.length() && m_pending[next] == '\r') {
+      next++;
+    }
+    if (next < m_pending.length() && m_pending[next] == '\n') {
+      end = next+1;
+      break;
+    }
+  }
+  if (end == string::npos) {
+    return false;
+  }
+  string headers = m_pending.substr(0, end);
+  m_pending.erase(0, end);  // keep any pipelined request for the next round
+  headers.erase(remove(headers.begin(), headers.end(), '\r'), headers.end());
+  size_t pos = headers.find('\n');
+  m_request = headers.substr(0, pos);  // reduce to first line
+  headers.erase(0, pos+1);
+  // typical first line: GET /ehp/outsidetemp HTTP/1.1
+  m_http11 = false;
+  pos = m_request.rfind(" HTTP/");
+  if (pos != string::npos) {
+    m_http11 = m_request.substr(pos+6) > "1.0";
+    m_request.resize(pos);  // remove "HTTP/x.x" suffix
+  }
+  m_httpKeepAlive = m_http11;  // persistent by default since HTTP/1.1
+  m_httpIfNoneMatch.clear();
+  istringstream stream(headers);
+  string line;
+  bool unknownBodySize = false;
+  while (getline(stream, line)) {
+    pos = line.find(':');
+    if (pos == string::npos) {
+      continue;
+    }
+    string name = line.substr(0, pos);
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    pos = line.find_first_not_of(' ', pos+1);
+    string value = pos == string::npos ? "" : line.substr(pos);
+    if (name == "connection") {
+      transform(value.begin(), value.end(), value.begin(), ::tolower);
+      if (value.find("close") != string::npos) {
+        m_httpKeepAlive = false;
+      } else if (value.find("keep-alive") != string::npos) {
+        m_httpKeepAlive = true;
+      }
+    } else if (name == "if-none-match") {
+      m_httpIfNoneMatch = value;
+    } else if (name == "content-length") {
+      m_pendingBodySize = strtoul(value.c_str(), NULL, 10);  // skipped with the next data
+    } else if (name == "transfer-encoding") {
+      unknownBodySize = true;
+    }
+  }
+  if (unknownBodySize) {
+    m_httpKeepAlive = false;  // the end of the body is not determined here, so close after the response
+  }
+  pos = 0;
+  while ((pos=m_request.find('%', pos)) != string::npos && pos+2 < m_request.length()) {
+    unsigned int value1, value2;
+    if (sscanf(m_request.c_str()+pos+1, "%1x%1x", &value1, &value2) < 2) {
+      break;
+    }
+    m_request[pos] = static_cast<char>(((value1&0x0f) << 4) | (value2&0x0f));
+    m_request.erase(pos+1, 2);
+    pos++;
+  }
+  return true;
+}
+
+
 int Connection::m_ids = 0;
 
 #ifndef POLLRDHUP
@@ -39,14 +146,17 @@ void Connection::run() {
   int ret;
   struct timespec tdiff;
 
-  // set timeout
+  // set timeout (only needed for closing idle HTTP connections)
   tdiff.tv_sec = 2;
   tdiff.tv_nsec = 0;
+  struct timespec* timeout = m_isHttp ? &tdiff : NULL;
+  NetMessage message(m_isHttp);
   int notifyFD = m_notify.notifyFD();
   int sockFD = m_socket->getFD();
+  int updateFD = message.getUpdateFD();
 
 #ifdef HAVE_PPOLL
-  int nfds = 2;
+  int nfds = 3;
   struct pollfd fds[nfds];
 
   memset(fds, 0, sizeof(fds));
@@ -56,14 +166,21 @@ void Connection::run() {
 
   fds[1].fd = sockFD;
   fds[1].events = POLLIN | POLLERR | POLLHUP | POLLRDHUP;
+
+  fds[2].fd = updateFD;
+  fds[2].events = POLLIN;
 #else
 #ifdef HAVE_PSELECT
   int maxfd = (notifyFD > sockFD) ? notifyFD : sockFD;
+  if (updateFD > maxfd) {
+    maxfd = updateFD;
+  }
   fd_set checkfds, exceptfds;
 
   FD_ZERO(&checkfds);
   FD_SET(notifyFD, &checkfds);
   FD_SET(sockFD, &checkfds);
+  FD_SET(updateFD, &checkfds);
 
   FD_ZERO(&exceptfds);
   FD_SET(notifyFD, &exceptfds);
@@ -72,21 +189,22 @@ void Connection::run() {
 #endif
 
   bool closed = false;
-  NetMessage message(m_isHttp);
+  time_t lastActivity;
+  time(&lastActivity);
 
   while (!closed) {
 #ifdef HAVE_PPOLL
     // wait for new fd event
-    ret = ppoll(fds, nfds, &tdiff, NULL);
+    ret = ppoll(fds, nfds, timeout, NULL);
 #else
 #ifdef HAVE_PSELECT
     // set readfds to inital checkfds
     fd_set readfds = checkfds;
     // wait for new fd event
-    ret = pselect(maxfd + 1, &readfds, NULL, &exceptfds, &tdiff, NULL);
+    ret = pselect(maxfd + 1, &readfds, NULL, &exceptfds, timeout, NULL);
 #endif
 #endif
-    bool newData = false;
+    bool newData = false, update = false;
     if (ret != 0) {
 #ifdef HAVE_PPOLL
       // new data from notify
@@ -97,6 +215,8 @@ void Connection::run() {
       // new data from socket
       newData = fds[1].revents & POLLIN;
       closed = fds[1].revents & POLLRDHUP;
+      // changed messages for listening client
+      update = fds[2].revents & POLLIN;
 #else
 #ifdef HAVE_PSELECT
       // new data from notify
@@ -106,11 +226,23 @@ void Connection::run() {
       // new data from socket
       newData = FD_ISSET(sockFD, &readfds);
       closed = FD_ISSET(sockFD, &exceptfds);
+      // changed messages for listening client
+      update = FD_ISSET(updateFD, &readfds);
 #endif
 #endif
+    } else if (m_isHttp && !message.isListening()) {
+      time_t now;
+      time(&now);
+      if (now < lastActivity || now > lastActivity + HTTP_KEEPALIVE_TIMEOUT) {
+        logDebug(lf_network, "[%05d] idle timeout", getID());
+        break;
+      }
     }
 
-    if (newData || message.isListening()) {
+    if (update) {
+      message.consumeUpdateNotify();
+    }
+    if (newData || update) {
       char data[256];
 
       if (!m_socket->isValid()) {
@@ -124,22 +256,30 @@ void Connection::run() {
           break;
         }
         data[datalen] = '\0';
+        time(&lastActivity);
       } else {
         data[0] = '\0';
       }
 
       // decode client data
-      if (message.add(data)) {
+      bool complete = message.add(data) || (update && message.isListening());
+      while (complete) {
         m_netQueue->push(&message);
 
         // wait for result
         logDebug(lf_network, "[%05d] wait for result", getID());
-        string result = message.getResult();
-
-        if (!m_socket->isValid()) {
+        bool more;
+        do {
+          string result = message.getResult(&more);
+          if (m_socket->isValid()) {
+            m_socket->send(result.c_str(), result.size());
+          }  // else: drain the remaining parts as the message is still in use until the final part
+        } while (more);
+        if (message.isDisconnect() || !m_socket->isValid()) {
           break;
         }
-        m_socket->send(result.c_str(), result.size());
+        // handle further HTTP requests already received (pipelining)
+        complete = m_isHttp && message.add("");
       }
 
       if (message.isDisconnect() || !m_socket->isValid()) {
@@ -148,14 +288,19 @@ void Connection::run() {
     }
   }
 
+  if (message.isListening()) {
+    m_network->removeListener(&message);
+  }
   delete m_socket;
   m_socket = NULL;
+  m_network->addConnectionCpuTime(clockGetCpuMicros(self()));
   logInfo(lf_network, "[%05d] connection closed", getID());
 }
 
 
-Network::Network(const bool local, const uint16_t port, const uint16_t httpPort, Queue<NetMessage*>* netQueue)
-  : Thread(), m_netQueue(netQueue), m_listening(false) {
+Network::Network(const bool local, const uint16_t port, const uint16_t httpPort, LinkedQueue<NetMessage>* netQueue)
+  : Thread(), m_netQueue(netQueue), m_listening(false), m_connectionCpuTime(0) {
+  pthread_mutex_init(&m_listenersMutex, NULL);
   m_tcpServer = new TCPServer(port, local ? "127.0.0.1" : "0.0.0.0");
 
   if (m_tcpServer != NULL && m_tcpServer->start() == 0) {
@@ -186,6 +331,7 @@ Network::~Network() {
     delete m_httpServer;
   }
   join();
+  pthread_mutex_destroy(&m_listenersMutex);
 }
 
 void Network::run() {
@@ -281,7 +427,7 @@ void Network::run() {
       if (socket == NULL) {
         continue;
       }
-      Connection* connection = new Connection(socket, isHttp, m_netQueue);
+      Connection* connection = new Connection(socket, isHttp, m_netQueue, this);
       connection->start("connection");
       m_connections.push_back(connection);
       logInfo(lf_network, "[%05d] %s connection opened %s", connection->getID(), isHttp ? "HTTP" : "client",
@@ -290,6 +436,35 @@ void Network::run() {
   }
 }
 
+void Network::notifyMessageChanged(Message* message) {
+  pthread_mutex_lock(&m_listenersMutex);
+  for (auto listener : m_listeners) {
+    listener->addUpdate(message);
+  }
+  pthread_mutex_unlock(&m_listenersMutex);
+}
+
+void Network::addListener(NetMessage* message) {
+  pthread_mutex_lock(&m_listenersMutex);
+  m_listeners.remove(message);
+  m_listeners.push_back(message);
+  pthread_mutex_unlock(&m_listenersMutex);
+}
+
+void Network::removeListener(NetMessage* message) {
+  pthread_mutex_lock(&m_listenersMutex);
+  m_listeners.remove(message);
+  pthread_mutex_unlock(&m_listenersMutex);
+}
+
+void Network::clearUpdates() {
+  pthread_mutex_lock(&m_listenersMutex);
+  for (auto listener : m_listeners) {
+    listener->clearUpdates();
+  }
+  pthread_mutex_unlock(&m_listenersMutex);
+}
+
 void Network::cleanConnections() {
   list<Connection*>::iterator c_it;
   for (c_it = m_connections.begin(); c_it != m_connections.end(); c_it++) {
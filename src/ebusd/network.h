@@ -20,9 +20,14 @@
 #define EBUSD_NETWORK_H_
 
 #include <string>
+#include <atomic>
 #include <cstdio>
 #include <algorithm>
 #include <list>
+#include <set>
+#include <deque>
+#include "lib/ebus/message.h"
+#include "lib/utils/clock.h"
 #include "lib/utils/tcpsocket.h"
 #include "lib/utils/queue.h"
 #include "lib/utils/notify.h"
@@ -34,20 +39,36 @@ namespace ebusd {
  * The TCP and HTTP client request handling.
  */
 
+using std::set;
+using std::deque;
+
+/**
+ * the maximum size of a partial result not yet taken by the @a Connection before the producer stops adding parts
+ * (the remainder is then buffered completely, which is at most the size of the full result).
+ */
+#define RESULT_PART_MAX_PENDING 65536
+
 /** Forward declaration for @a Connection. */
 class Connection;
 
+/** Forward declaration for @a Network. */
+class Network;
+
 /**
  * Class for data/message transfer between @a Connection and @a MainLoop.
  */
 class NetMessage {
+  friend class LinkedQueue<NetMessage>;
+
  public:
   /**
    * Constructor.
    * @param isHttp whether this is a HTTP message.
    */
   explicit NetMessage(const bool isHttp)
-    : m_isHttp(isHttp), m_resultSet(false), m_disconnect(false), m_listening(false), m_listenSince(0) {
+    : m_isHttp(isHttp), m_http11(false), m_httpKeepAlive(false), m_pendingBodySize(0), m_resultSet(false),
+      m_disconnect(false),
+      m_listening(false), m_queueNext(NULL) {
     pthread_mutex_init(&m_mutex, NULL);
     pthread_cond_init(&m_cond, NULL);
   }
@@ -75,37 +96,7 @@ class NetMessage {
    * @param request the request data from the client.
    * @return true when the request is complete and the response shall be prepared.
    */
-  bool add(string request) {
-    if (request.length() > 0) {
-      request.erase(remove(request.begin(), request.end(), '\r'), request.end());
-      m_request.append(request);
-    }
-    size_t pos = m_request.find(m_isHttp ? "\n\n" : "\n");
-    if (pos != string::npos) {
-      if (m_isHttp) {
-        pos = m_request.find("\n");
-        m_request.resize(pos);  // reduce to first line
-        // typical first line: GET /ehp/outsidetemp HTTP/1.1
-        pos = m_request.rfind(" HTTP/");
-        if (pos != string::npos) {
-          m_request.resize(pos);  // remove "HTTP/x.x" suffix
-        }
-        pos = 0;
-        while ((pos=m_request.find('%', pos)) != string::npos && pos+2 <= m_request.length()) {
-          unsigned int value1, value2;
-          if (sscanf("%1x%1x", m_request.c_str()+pos+1, &value1, &value2) < 2) {
-            break;
-          }
-          m_request[pos] = static_cast<char>(((value1&0x0f) << 4) | (value2&0x0f));
-          m_request.erase(pos+1, 2);
-        }
-      } else if (pos+1 == m_request.length()) {
-        m_request.resize(pos);  // reduce to complete lines
-      }
-      return true;
-    }
-    return m_request.length() == 0 && m_listening;
-  }
+  bool add(const string& request);
 
   /**
    * Return whether this is a HTTP message.
@@ -113,6 +104,24 @@ class NetMessage {
    */
   bool isHttp() const { return m_isHttp; }
 
+  /**
+   * Return whether the HTTP client uses protocol version 1.1 (and thus understands chunked transfer encoding).
+   * @return whether the HTTP client uses protocol version 1.1.
+   */
+  bool isHttp11() const { return m_http11; }
+
+  /**
+   * Return whether the HTTP client requested the connection to be kept open after the response.
+   * @return whether the HTTP client requested the connection to be kept open.
+   */
+  bool isHttpKeepAlive() const { return m_httpKeepAlive; }
+
+  /**
+   * Return the entity tags from the "If-None-Match" header of the HTTP request.
+   * @return the entity tags from the "If-None-Match" header, or empty.
+   */
+  string getHttpIfNoneMatch() const { return m_httpIfNoneMatch; }
+
   /**
    * Return the request string.
    * @return the request string.
@@ -126,51 +135,69 @@ class NetMessage {
   string getUser() const { return m_user; }
 
   /**
-   * Wait for the result being set and return the result string.
+   * Wait for the result or a part of it being set and return the result string.
+   * @param more set to true when this is only a part of the result and further parts are to be expected.
    * @return the result string.
    */
-  string getResult() {
+  string getResult(bool* more) {
     pthread_mutex_lock(&m_mutex);
 
-    while (!m_resultSet)
+    while (!m_resultSet && m_result.empty())
       pthread_cond_wait(&m_cond, &m_mutex);
 
-    m_request.clear();
-    string result = m_result;
-    m_result.clear();
-    m_resultSet = false;
+    *more = !m_resultSet;
+    if (m_resultSet) {
+      if (!m_isHttp || !m_listening) {
+        m_request.clear();  // keep the request of a streaming HTTP client for formatting further updates
+      }
+      m_resultSet = false;
+    }
+    string result;
+    result.swap(m_result);
+    pthread_cond_broadcast(&m_cond);
     pthread_mutex_unlock(&m_mutex);
 
     return result;
   }
 
   /**
-   * Set the result string and notify the waiting thread.
+   * Add a part of the result string and notify the waiting thread (without waiting for it to be taken).
+   * @param part the result string part.
+   * @return true when further parts may be added, false when more than @a RESULT_PART_MAX_PENDING is still
+   * pending and the remainder shall be passed to @a setResult() at once.
+   */
+  bool addResultPart(const string& part) {
+    pthread_mutex_lock(&m_mutex);
+    m_result += part;
+    bool ret = m_result.length() <= RESULT_PART_MAX_PENDING;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+    return ret;
+  }
+
+  /**
+   * Set the (final part of the) result string and notify the waiting thread.
    * @param result the result string.
    * @param user the new user name.
    * @param listening whether the client is in listening mode.
-   * @param listenUntil the end time to which to updates were added (exclusive).
    * @param disconnect true when the client shall be disconnected.
    */
-  void setResult(const string result, const string user, const bool listening, const time_t listenUntil,
-      const bool disconnect) {
+  void setResult(const string result, const string user, const bool listening, const bool disconnect) {
     pthread_mutex_lock(&m_mutex);
-    m_result = result;
+    m_result += result;
     m_user = user;
     m_disconnect = disconnect;
     m_listening = listening;
-    m_listenSince = listenUntil;
     m_resultSet = true;
-    pthread_cond_signal(&m_cond);
+    pthread_cond_broadcast(&m_cond);
     pthread_mutex_unlock(&m_mutex);
   }
 
   /**
    * Return whether the client is in listening mode.
-   * @param listenSince set to the start time from which to add updates (inclusive).
    * @return whether the client is in listening mode.
    */
-  bool isListening(time_t* listenSince=NULL) { if (listenSince) { *listenSince = m_listenSince; } return m_listening; }
+  bool isListening() { return m_listening; }
 
   /**
    * Return whether the client shall be disconnected.
@@ -178,14 +205,74 @@ class NetMessage {
    */
   bool isDisconnect() { return m_disconnect; }
 
+  /**
+   * Add a changed @a Message to be sent to the listening client and notify the waiting thread.
+   * @param message the changed @a Message.
+   */
+  void addUpdate(Message* message) {
+    pthread_mutex_lock(&m_mutex);
+    bool notify = m_updates.empty();
+    m_updates.insert(message);
+    pthread_mutex_unlock(&m_mutex);
+    if (notify) {
+      m_updateNotify.notify();
+    }
+  }
+
+  /**
+   * Take the changed @a Message instances collected for the listening client.
+   * @param updates the @a deque to add the changed @a Message instances to.
+   */
+  void takeUpdates(deque<Message*>& updates) {
+    pthread_mutex_lock(&m_mutex);
+    updates.insert(updates.end(), m_updates.begin(), m_updates.end());
+    m_updates.clear();
+    pthread_mutex_unlock(&m_mutex);
+  }
+
+  /**
+   * Drop all changed @a Message instances collected so far (e.g. when the instances are about to be deleted).
+   */
+  void clearUpdates() {
+    pthread_mutex_lock(&m_mutex);
+    m_updates.clear();
+    pthread_mutex_unlock(&m_mutex);
+  }
+
+  /**
+   * Return the file descriptor to watch for changed @a Message instances being available.
+   * @return the file descriptor to watch.
+   */
+  int getUpdateFD() { return m_updateNotify.notifyFD(); }
+
+  /**
+   * Consume the notification about changed @a Message instances being available.
+   */
+  void consumeUpdateNotify() { m_updateNotify.consume(); }
+
 
  private:
   /** whether this is a HTTP message. */
   const bool m_isHttp;
 
+  /** whether the HTTP client uses protocol version 1.1. */
+  bool m_http11;
+
+  /** whether the HTTP client requested the connection to be kept open. */
+  bool m_httpKeepAlive;
+
+  /** the entity tags from the "If-None-Match" header of the HTTP request. */
+  string m_httpIfNoneMatch;
+
   /** the request string. */
   string m_request;
 
+  /** the received data not yet consumed by a complete request (HTTP pipelining). */
+  string m_pending;
+
+  /** the number of bytes of the last HTTP request body still to be skipped. */
+  size_t m_pendingBodySize;
+
   /** the current user name. */
   string m_user;
 
@@ -207,8 +294,14 @@ class NetMessage {
   /** whether the client is in listening mode. */
   bool m_listening;
 
-  /** start timestamp of listening update. */
-  time_t m_listenSince;
+  /** the changed @a Message instances not yet sent to the listening client. */
+  set<Message*> m_updates;
+
+  /** @a Notify object for changed @a Message instances being available. */
+  Notify m_updateNotify;
+
+  /** the next @a NetMessage in the @a LinkedQueue this instance is currently part of. */
+  NetMessage* m_queueNext;
 };
 
 /**
@@ -221,9 +314,10 @@ class Connection : public Thread {
    * @param socket the @a TCPSocket for communication.
    * @param isHttp whether this is a HTTP message.
    * @param netQueue the reference to the @a NetMessage @a Queue.
+   * @param network the @a Network for (un-)registering listening @a NetMessage instances.
    */
-  Connection(TCPSocket* socket, const bool isHttp, Queue<NetMessage*>* netQueue)
-    : Thread(), m_isHttp(isHttp), m_socket(socket), m_netQueue(netQueue) {
+  Connection(TCPSocket* socket, const bool isHttp, LinkedQueue<NetMessage>* netQueue, Network* network)
+    : Thread(), m_isHttp(isHttp), m_socket(socket), m_netQueue(netQueue), m_network(network) {
     m_id = ++m_ids;
   }
 
@@ -253,7 +347,10 @@ class Connection : public Thread {
   TCPSocket* m_socket;
 
   /** the reference to the @a NetMessage @a Queue. */
-  Queue<NetMessage*>* m_netQueue;
+  LinkedQueue<NetMessage>* m_netQueue;
+
+  /** the @a Network for (un-)registering listening @a NetMessage instances. */
+  Network* m_network;
 
   /** notification object for shutdown procedure. */
   Notify m_notify;
@@ -268,7 +365,7 @@ class Connection : public Thread {
 /**
  * class network which listening on tcp socket for incoming connections.
  */
-class Network : public Thread {
+class Network : public Thread, public MessageListener {
  public:
   /**
    * create a network instance and listening for incoming connections.
@@ -277,7 +374,7 @@ class Network : public Thread {
    * @param httpPort the port to listen for HTTP connections, or 0.
    * @param netQueue the reference to the @a NetMessage @a Queue.
    */
-  Network(const bool local, const uint16_t port, const uint16_t httpPort, Queue<NetMessage*>* netQueue);
+  Network(const bool local, const uint16_t port, const uint16_t httpPort, LinkedQueue<NetMessage>* netQueue);
 
   /**
    * destructor.
@@ -294,13 +391,46 @@ class Network : public Thread {
    */
   void stop() const { m_notify.notify(); usleep(100000); }
 
+  // @copydoc
+  void notifyMessageChanged(Message* message) override;
+
+  /**
+   * Register a listening @a NetMessage for being notified about changed @a Message instances.
+   * @param message the listening @a NetMessage.
+   */
+  void addListener(NetMessage* message);
+
+  /**
+   * Unregister a @a NetMessage from being notified about changed @a Message instances.
+   * @param message the @a NetMessage to unregister.
+   */
+  void removeListener(NetMessage* message);
+
+  /**
+   * Drop the changed @a Message instances collected for all listening @a NetMessage instances (e.g. when the
+   * instances are about to be deleted).
+   */
+  void clearUpdates();
+
+  /**
+   * Add the CPU time consumed by a closed @a Connection.
+   * @param micros the consumed CPU time in microseconds.
+   */
+  void addConnectionCpuTime(uint64_t micros) { m_connectionCpuTime.fetch_add(micros, std::memory_order_relaxed); }
+
+  /**
+   * Return the CPU time consumed by all closed @a Connection instances.
+   * @return the consumed CPU time in microseconds.
+   */
+  uint64_t getConnectionCpuTime() const { return m_connectionCpuTime.load(std::memory_order_relaxed); }
+
 
  private:
   /** the list of active @a Connection instances. */
   list<Connection*> m_connections;
 
   /** the reference to the @a NetMessage @a Queue. */
-  Queue<NetMessage*>* m_netQueue;
+  LinkedQueue<NetMessage>* m_netQueue;
 
   /** the command line @a TCPServer instance. */
   TCPServer* m_tcpServer;
@@ -314,6 +444,15 @@ class Network : public Thread {
   /** true if this instance is listening */
   bool m_listening;
 
+  /** the listening @a NetMessage instances to notify about changed @a Message instances. */
+  list<NetMessage*> m_listeners;
+
+  /** mutex for accessing @a m_listeners. */
+  pthread_mutex_t m_listenersMutex;
+
+  /** the CPU time in microseconds consumed by all closed @a Connection instances. */
+  std::atomic<uint64_t> m_connectionCpuTime;
+
   /**
    * clean inactive connections from container.
    */
@@ -24,17 +24,13 @@
 #include <math.h>
 #include <iostream>
 #include <sstream>
-#include <iomanip>
 #include <vector>
+#include <cstdio>
 #include <cstring>
 #include "lib/ebus/datatype.h"
 
 namespace ebusd {
 
-using std::setfill;
-using std::setw;
-using std::dec;
-
 void contrib_tem_register() {
   DataTypeList::getInstance()->add(new TemParamDataType("TEM_P"));
 }
@@ -53,40 +49,31 @@ result_t TemParamDataType::derive(int divisor, size_t bitCount, const NumberData
   return RESULT_ERR_INVALID_ARG;
 }
 
-result_t TemParamDataType::readSymbols(const SymbolString& input,
+result_t TemParamDataType::readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const {
-  unsigned int value = 0;
+    DataValue& value) const {
+  unsigned int rawValue = 0;
 
-  result_t result = readRawValue(input, offset, length, value);
+  result_t result = readRawValue(input, offset, length, rawValue);
   if (result != RESULT_OK) {
     return result;
   }
 
-  if (value == m_replacement) {
-    if (outputFormat & OF_JSON) {
-      output << "null";
-    } else {
-      output << NULL_VALUE;
-    }
+  if (rawValue == m_replacement) {
+    value.setNull();
     return RESULT_OK;
   }
   int grp = 0, num = 0;
   if (input.isMaster()) {
-    grp = (value & 0x1f);  // grp in bits 0...5
-    num = ((value >> 8) & 0x7f);  // num in bits 8...13
+    grp = (rawValue & 0x1f);  // grp in bits 0...5
+    num = ((rawValue >> 8) & 0x7f);  // num in bits 8...13
   } else {
-    grp = ((value >> 7) & 0x1f);  // grp in bits 7...11
-    num = (value & 0x7f);  // num in bits 0...6
-  }
-  if (outputFormat & OF_JSON) {
-    output << '"';
-  }
-  output << setfill('0') << setw(2) << dec << static_cast<int>(grp) << '-' << setw(3) << static_cast<int>(num);
-  if (outputFormat & OF_JSON) {
-    output << '"';
+    grp = ((rawValue >> 7) & 0x1f);  // grp in bits 7...11
+    num = (rawValue & 0x7f);  // num in bits 0...6
   }
-  output << setfill(' ') << setw(0);  // reset
+  char str[8];
+  snprintf(str, sizeof(str), "%02d-%03d", grp, num);
+  value.setString(str);
   return RESULT_OK;
 }
 
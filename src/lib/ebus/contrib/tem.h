@@ -53,9 +53,9 @@ class TemParamDataType : public NumberDataType {
   result_t derive(int divisor, size_t bitCount, const NumberDataType* &derived) const override;
 
   // @copydoc
-  result_t readSymbols(const SymbolString& input,
+  result_t readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const override;
+    DataValue& value) const override;
 
   // @copydoc
   result_t writeSymbols(istringstream& input,
@@ -85,8 +85,9 @@ const string AttributedItem::pluck(map<string, string>& row, string key) {
   if (it == row.end()) {
     return "";
   }
+  string value = it->second;
   row.erase(it);
-  return it->second;
+  return value;
 }
 
 void AttributedItem::dumpString(ostream& output, const string str, const bool prependFieldSeparator) {
@@ -100,29 +101,57 @@ void AttributedItem::dumpString(ostream& output, const string str, const bool pr
   }
 }
 
-void AttributedItem::appendJson(ostream& output, const string name, const string value,
+void AttributedItem::appendJson(ostream& output, const string& name, const string& value,
     const bool prependFieldSeparator, bool asString) {
-  bool plain;
-  if (asString) {
-    plain = false;
-  } else {
-    plain = value == "false" || value == "true";
-    if (!plain) {
-      const char* str = value.c_str();
-      char* strEnd = NULL;
-      strtod(str, &strEnd);
-      plain = strEnd && !*strEnd;
-    }
-  }
   if (prependFieldSeparator) {
     output << FIELD_SEPARATOR;
   }
-  output << " \"" << name << "\": ";
-  if (plain) {
-    output << value;
+  output.write(" \"", 2);
+  output.write(name.data(), name.length());
+  output.write("\": ", 3);
+  if (!asString && (value == "false" || value == "true" || isJsonNumber(value))) {
+    output.write(value.data(), value.length());
+  } else {
+    appendJsonString(output, value);
+  }
+}
+
+bool AttributedItem::isJsonNumber(const string& value) {
+  const char* str = value.c_str();
+  if (*str == '-') {
+    str++;
+  }
+  if (*str == '0') {
+    str++;
+  } else if (*str >= '1' && *str <= '9') {
+    while (*str >= '0' && *str <= '9') {
+      str++;
+    }
   } else {
-    output << '"' << value << '"';
+    return false;
   }
+  if (*str == '.') {
+    str++;
+    if (*str < '0' || *str > '9') {
+      return false;
+    }
+    while (*str >= '0' && *str <= '9') {
+      str++;
+    }
+  }
+  if (*str == 'e' || *str == 'E') {
+    str++;
+    if (*str == '+' || *str == '-') {
+      str++;
+    }
+    if (*str < '0' || *str > '9') {
+      return false;
+    }
+    while (*str >= '0' && *str <= '9') {
+      str++;
+    }
+  }
+  return str == value.c_str() + value.length();
 }
 
 void AttributedItem::mergeAttributes(map<string, string>& attributes) const {
@@ -519,10 +548,13 @@ result_t SingleDataField::read(const SymbolString& data, size_t offset,
     if (outputIndex >= 0 || m_name.empty() || !(outputFormat & OF_NAMES)) {
       output << "\"" << static_cast<signed int>(outputIndex < 0 ? 0 : outputIndex) << "\":";
       if (!shortFormat) {
-        output << " {\"name\": \"" << m_name << "\"" << ", \"value\": ";
+        output << " {\"name\": ";
+        appendJsonString(output, m_name);
+        output << ", \"value\": ";
       }
     } else {
-      output << "\"" << m_name << "\":";
+      appendJsonString(output, m_name);
+      output << ':';
       if (!shortFormat) {
         output << " {\"value\": ";
       }
@@ -549,6 +581,37 @@ result_t SingleDataField::read(const SymbolString& data, size_t offset,
   return RESULT_OK;
 }
 
+result_t SingleDataField::readValues(const SymbolString& data, size_t offset,
+    vector<DataValue>& values, vector<string>* names) const {
+  if (m_partType == pt_any) {
+    return RESULT_ERR_INVALID_PART;
+  }
+  if ((data.isMaster() ? pt_masterData : pt_slaveData) != m_partType) {
+    return RESULT_OK;
+  }
+  bool remainder = m_length == REMAIN_LEN && m_dataType->isAdjustableLength();
+  if (offset + (remainder?1:m_length) > data.getDataSize()) {
+    return RESULT_ERR_INVALID_POS;
+  }
+  if (isIgnored()) {
+    return RESULT_OK;
+  }
+  values.emplace_back();
+  result_t result = readValue(data, offset, values.back());
+  if (result != RESULT_OK) {
+    values.pop_back();
+    return result;
+  }
+  if (names) {
+    names->push_back(m_name);
+  }
+  return RESULT_OK;
+}
+
+result_t SingleDataField::readValue(const SymbolString& input, const size_t offset, DataValue& value) const {
+  return m_dataType->readValue(input, offset, m_length, value);
+}
+
 result_t SingleDataField::write(istringstream& input, SymbolString& data,
     size_t offset, char separator, size_t* length) const {
   if (m_partType == pt_any) {
@@ -563,7 +626,13 @@ result_t SingleDataField::write(istringstream& input, SymbolString& data,
 result_t SingleDataField::readSymbols(const SymbolString& input,
     const size_t offset,
     ostringstream& output, OutputFormat outputFormat) const {
-  return m_dataType->readSymbols(input, offset, m_length, output, outputFormat);
+  DataValue value;
+  result_t result = readValue(input, offset, value);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  value.format(output, outputFormat);
+  return RESULT_OK;
 }
 
 result_t SingleDataField::writeSymbols(istringstream& input,
@@ -693,33 +762,20 @@ void ValueListDataField::dump(ostream& output) const {
   dumpAttribute(output, "comment");
 }
 
-result_t ValueListDataField::readSymbols(const SymbolString& input,
-    const size_t offset,
-    ostringstream& output, OutputFormat outputFormat) const {
-  unsigned int value = 0;
-
-  result_t result = m_dataType->readRawValue(input, offset, m_length, value);
+result_t ValueListDataField::readValue(const SymbolString& input, const size_t offset,
+    DataValue& value) const {
+  unsigned int rawValue = 0;
+  result_t result = m_dataType->readRawValue(input, offset, m_length, rawValue);
   if (result != RESULT_OK) {
     return result;
   }
-  auto it = m_values.find(value);
-  if (it == m_values.end() && value != m_dataType->getReplacement()) {
-    // fall back to raw value in input
-    output << setw(0) << dec << static_cast<unsigned>(value);
-    return RESULT_OK;
-  }
-  if (it == m_values.end()) {
-    if (outputFormat & OF_JSON) {
-      output << "null";
-    } else if (value == m_dataType->getReplacement()) {
-      output << NULL_VALUE;
-    }
-  } else if (outputFormat & OF_NUMERIC) {
-    output << setw(0) << dec << static_cast<unsigned>(value);
-  } else if (outputFormat & OF_JSON) {
-    output << '"' << it->second << '"';
+  auto it = m_values.find(rawValue);
+  if (it != m_values.end()) {
+    value.setInteger(rawValue, it->second);
+  } else if (rawValue == m_dataType->getReplacement()) {
+    value.setNull();
   } else {
-    output << it->second;
+    value.setInteger(rawValue);  // fall back to raw value in input
   }
   return RESULT_OK;
 }
@@ -798,24 +854,29 @@ void ConstantDataField::dump(ostream& output) const {
   dumpAttribute(output, "comment");
 }
 
-result_t ConstantDataField::readSymbols(const SymbolString& input,
-    const size_t offset,
-    ostringstream& output, OutputFormat outputFormat) const {
-  ostringstream coutput;
-  result_t result = SingleDataField::readSymbols(input, offset, coutput, 0);
-  if (result != RESULT_OK) {
+result_t ConstantDataField::readValue(const SymbolString& input, const size_t offset,
+    DataValue& value) const {
+  result_t result = SingleDataField::readValue(input, offset, value);
+  if (result != RESULT_OK || !m_verify) {
     return result;
   }
-  if (m_verify) {
-    string value = coutput.str();
-    FileReader::trim(value);
-    if (value != m_value) {
-      return RESULT_ERR_OUT_OF_RANGE;
-    }
+  ostringstream coutput;
+  value.format(coutput, 0);
+  string str = coutput.str();
+  FileReader::trim(str);
+  if (str != m_value) {
+    return RESULT_ERR_OUT_OF_RANGE;
   }
   return RESULT_OK;
 }
 
+result_t ConstantDataField::readSymbols(const SymbolString& input,
+    const size_t offset,
+    ostringstream& output, OutputFormat outputFormat) const {
+  DataValue value;
+  return readValue(input, offset, value);
+}
+
 result_t ConstantDataField::writeSymbols(istringstream& input,
     const size_t offset,
     SymbolString& output, size_t* usedLength) const {
@@ -1049,6 +1110,27 @@ result_t DataFieldSet::read(const SymbolString& data, size_t offset,
   return RESULT_OK;
 }
 
+result_t DataFieldSet::readValues(const SymbolString& data, size_t offset,
+    vector<DataValue>& values, vector<string>* names) const {
+  bool previousFullByteOffset = true;
+  PartType partType = data.isMaster() ? pt_masterData : pt_slaveData;
+  for (auto field : m_fields) {
+    if (field->getPartType() != partType) {
+      continue;
+    }
+    if (!previousFullByteOffset && !field->hasFullByteOffset(false)) {
+      offset--;
+    }
+    result_t result = field->readValues(data, offset, values, names);
+    if (result < RESULT_OK) {
+      return result;
+    }
+    offset += field->getLength(partType, data.getDataSize()-offset);
+    previousFullByteOffset = field->hasFullByteOffset(true);
+  }
+  return RESULT_OK;
+}
+
 result_t DataFieldSet::write(istringstream& input, SymbolString& data,
     size_t offset, char separator, size_t* length) const {
   string token;
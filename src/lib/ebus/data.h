@@ -118,9 +118,16 @@ class AttributedItem {
    * @param prependFieldSeparator whether to start with a @a FIELD_SEPARATOR.
    * @param asString true to force writing as string, false to detect the type from the value.
    */
-  static void appendJson(ostream& output, const string name, const string value,
+  static void appendJson(ostream& output, const string& name, const string& value,
       const bool prependFieldSeparator = true, bool asString = false);
 
+  /**
+   * Return whether the value is a valid JSON number.
+   * @param value the value to check.
+   * @return true when the value is a valid JSON number.
+   */
+  static bool isJsonNumber(const string& value);
+
   /**
    * Merge this instance's additional named attributes into the specified attributes.
    * @param attributes the additional named attributes to merge in this instance's additional named attributes.
@@ -263,6 +270,19 @@ class DataField : public AttributedItem {
    */
   virtual string getName(const ssize_t fieldIndex = -1) const { return m_name; }
 
+  /**
+   * Get the number of fields.
+   * @return the number of fields (1 for a single field).
+   */
+  virtual size_t getFieldCount() const { return 1; }
+
+  /**
+   * Get the specified @a SingleDataField.
+   * @param fieldIndex the index of the field.
+   * @return the @a SingleDataField, or NULL if not available.
+   */
+  virtual const SingleDataField* getField(const size_t fieldIndex) const = 0;
+
   /**
    * Dump the field settings to the output.
    * @param output the @a ostream to dump to.
@@ -310,6 +330,17 @@ class DataField : public AttributedItem {
     ostringstream& output, OutputFormat outputFormat, ssize_t outputIndex = -1,
     bool leadingSeparator = false, const char* fieldName = NULL, ssize_t fieldIndex = -1) const = 0;
 
+  /**
+   * Reads the typed values of all fields from the @a SymbolString.
+   * @param data the data @a SymbolString for reading binary data.
+   * @param offset the additional offset to add for reading binary data.
+   * @param values the vector to append the @a DataValue of each field to (ignored fields are skipped).
+   * @param names the vector to append the name of each field to, or NULL.
+   * @return @a RESULT_OK on success (or if the partType does not match), or an error code.
+   */
+  virtual result_t readValues(const SymbolString& data, size_t offset,
+    vector<DataValue>& values, vector<string>* names = NULL) const = 0;
+
   /**
    * Writes the value to the master or slave @a SymbolString.
    * @param input the @a istringstream to parse the formatted value from.
@@ -375,12 +406,23 @@ class SingleDataField : public DataField {
    */
   bool isIgnored() const { return m_dataType->isIgnored(); }
 
+  /**
+   * Get the data type definition.
+   * @return the data type definition.
+   */
+  const DataType* getDataType() const { return m_dataType; }
+
   /**
    * Get the message part in which the field is stored.
    * @return the message part in which the field is stored.
    */
   PartType getPartType() const { return m_partType; }
 
+  // @copydoc
+  const SingleDataField* getField(const size_t fieldIndex) const override {
+    return fieldIndex == 0 ? this : NULL;
+  }
+
   // @copydoc
   size_t getLength(PartType partType, size_t maxLength = MAX_LEN) const override;
 
@@ -411,6 +453,10 @@ class SingleDataField : public DataField {
     ostringstream& output, OutputFormat outputFormat, ssize_t outputIndex = -1,
     bool leadingSeparator = false, const char* fieldName = NULL, ssize_t fieldIndex = -1) const override;
 
+  // @copydoc
+  result_t readValues(const SymbolString& data, size_t offset,
+    vector<DataValue>& values, vector<string>* names = NULL) const override;
+
   // @copydoc
   result_t write(istringstream& input, SymbolString& data,
     size_t offset, char separator = UI_FIELD_SEPARATOR, size_t* length = NULL) const override;
@@ -418,7 +464,16 @@ class SingleDataField : public DataField {
 
  protected:
   /**
-   * Internal method for reading the field from a @a SymbolString.
+   * Internal method for reading the typed value of the field from a @a SymbolString.
+   * @param input the @a SymbolString to read the binary value from.
+   * @param offset the offset in the @a SymbolString.
+   * @param value the @a DataValue in which to store the decoded value.
+   * @return @a RESULT_OK on success, or an error code.
+   */
+  virtual result_t readValue(const SymbolString& input, const size_t offset, DataValue& value) const;
+
+  /**
+   * Internal method for reading the field from a @a SymbolString (formatted from @a readValue()).
    * @param input the @a SymbolString to read the binary value from.
    * @param offset the offset in the @a SymbolString.
    * @param output the ostringstream to append the formatted value to.
@@ -479,6 +534,12 @@ class ValueListDataField : public SingleDataField {
   // @copydoc
   const ValueListDataField* clone() const override;
 
+  /**
+   * Get the value=text assignments.
+   * @return the value=text assignments.
+   */
+  const map<unsigned int, string>& getValues() const { return m_values; }
+
   // @copydoc
   result_t derive(const string name, map<string, string> attributes, const PartType partType,
       int divisor, map<unsigned int, string> values, vector<const SingleDataField*>& fields) const override;
@@ -489,8 +550,7 @@ class ValueListDataField : public SingleDataField {
 
  protected:
   // @copydoc
-  result_t readSymbols(const SymbolString& input, const size_t offset,
-    ostringstream& output, OutputFormat outputFormat) const override;
+  result_t readValue(const SymbolString& input, const size_t offset, DataValue& value) const override;
 
   // @copydoc
   result_t writeSymbols(istringstream& input, const size_t offset,
@@ -540,6 +600,9 @@ class ConstantDataField : public SingleDataField {
 
 
  protected:
+  // @copydoc
+  result_t readValue(const SymbolString& input, const size_t offset, DataValue& value) const override;
+
   // @copydoc
   result_t readSymbols(const SymbolString& input, const size_t offset,
     ostringstream& output, OutputFormat outputFormat) const override;
@@ -612,6 +675,14 @@ class DataFieldSet : public DataField {
   // @copydoc
   string getName(const ssize_t fieldIndex = -1) const override;
 
+  // @copydoc
+  size_t getFieldCount() const override { return m_fields.size(); }
+
+  // @copydoc
+  const SingleDataField* getField(const size_t fieldIndex) const override {
+    return fieldIndex < m_fields.size() ? m_fields[fieldIndex] : NULL;
+  }
+
   // @copydoc
   result_t derive(const string name, map<string, string> attributes, const PartType partType,
     int divisor, map<unsigned int, string> values, vector<const SingleDataField*>& fields) const override;
@@ -661,6 +732,10 @@ class DataFieldSet : public DataField {
     ostringstream& output, OutputFormat outputFormat, ssize_t outputIndex = -1,
     bool leadingSeparator = false, const char* fieldName = NULL, ssize_t fieldIndex = -1) const override;
 
+  // @copydoc
+  result_t readValues(const SymbolString& data, size_t offset,
+    vector<DataValue>& values, vector<string>* names = NULL) const override;
+
   // @copydoc
   result_t write(istringstream& input, SymbolString& data,
     size_t offset, char separator = UI_FIELD_SEPARATOR, size_t* length = NULL) const override;
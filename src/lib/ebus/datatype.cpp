@@ -42,6 +42,166 @@ using std::setw;
 using std::endl;
 
 
+void appendJsonString(ostream& output, const string& value) {
+  static const char* hexDigits = "0123456789abcdef";
+  output.put('"');
+  const char* str = value.data();
+  size_t len = value.length(), start = 0;
+  for (size_t pos = 0; pos < len; pos++) {
+    unsigned char ch = static_cast<unsigned char>(str[pos]);
+    if (ch >= 0x20 && ch != '"' && ch != '\\') {
+      continue;
+    }
+    if (pos > start) {
+      output.write(str+start, pos-start);
+    }
+    start = pos+1;
+    char escaped[6] = {'\\', 'u', '0', '0', hexDigits[ch >> 4], hexDigits[ch & 0x0f]};
+    size_t escapedLen = 2;
+    switch (ch) {
+      case '"': escaped[1] = '"'; break;
+      case '\\': escaped[1] = '\\'; break;
+      case '\b': escaped[1] = 'b'; break;
+      case '\f': escaped[1] = 'f'; break;
+      case '\n': escaped[1] = 'n'; break;
+      case '\r': escaped[1] = 'r'; break;
+      case '\t': escaped[1] = 't'; break;
+      default: escapedLen = 6; break;
+    }
+    output.write(escaped, escapedLen);
+  }
+  if (len > start) {
+    output.write(str+start, len-start);
+  }
+  output.put('"');
+}
+
+
+size_t formatDecimal(int64_t value, size_t precision, size_t width, char* buffer, size_t size) {
+  char digits[20];
+  char* end = digits + sizeof(digits);
+  char* pos = end;
+  uint64_t remain = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    *--pos = static_cast<char>('0' + remain % 10);
+    remain /= 10;
+  } while (remain > 0);
+  size_t count = static_cast<size_t>(end - pos);
+  size_t intCount = count > precision ? count - precision : 1;
+  size_t length = (value < 0 ? 1 : 0) + intCount + (precision > 0 ? 1 + precision : 0);
+  size_t fill = width > length ? width - length : 0;
+  if (fill + length > size) {
+    return 0;
+  }
+  char* out = buffer;
+  for (; fill > 0; fill--) {
+    *out++ = '0';  // filled up in front of the sign like right adjusted stream output
+  }
+  if (value < 0) {
+    *out++ = '-';
+  }
+  if (count > precision) {
+    memcpy(out, pos, intCount);
+    out += intCount;
+    pos += intCount;
+  } else {
+    *out++ = '0';
+  }
+  if (precision > 0) {
+    *out++ = '.';
+    for (size_t zeros = precision - static_cast<size_t>(end - pos); zeros > 0; zeros--) {
+      *out++ = '0';
+    }
+    memcpy(out, pos, static_cast<size_t>(end - pos));
+    out += end - pos;
+  }
+  return static_cast<size_t>(out - buffer);
+}
+
+
+void DataValue::format(ostream& output, OutputFormat outputFormat) const {
+  bool json = (outputFormat & OF_JSON) != 0;
+  char buffer[96];
+  size_t length = 0;
+  switch (m_type) {
+  case vt_null:
+    if (json) {
+      output << "null";
+    } else {
+      output << NULL_VALUE;
+    }
+    return;
+  case vt_integer:
+    output.width(0);
+    output.setf(std::ios::dec, std::ios::basefield);
+    if (!m_text.empty() && !(outputFormat & OF_NUMERIC)) {
+      if (json) {
+        appendJsonString(output, m_text);
+      } else {
+        output << m_text;
+      }
+      return;
+    }
+    if (m_width == 0) {
+      json = false;
+    } else {
+      output.fill('0');  // keep the stream state as with previous stream formatting
+      if (json) {
+        buffer[length++] = '"';
+      }
+    }
+    length += formatDecimal(m_integer, 0, m_width, buffer+length, sizeof(buffer)-length-1);
+    break;
+  case vt_float:
+    output.width(0);
+    output.setf(std::ios::dec, std::ios::basefield);
+    if (m_precision >= 0) {
+      output.setf(std::ios::fixed, std::ios::floatfield);
+      output.precision(m_precision);
+    }
+    if (m_decimal) {
+      length = formatDecimal(m_integer, static_cast<size_t>(m_precision), 0, buffer, sizeof(buffer));
+    }
+    if (length == 0) {
+      output << static_cast<float>(m_float);  // formatted in single precision like the value range of the types
+      return;
+    }
+    json = false;
+    break;
+  case vt_string:
+    if (json) {
+      appendJsonString(output, m_text);
+    } else {
+      output << m_text;
+    }
+    return;
+  case vt_date:
+  case vt_time:
+    output.setf(std::ios::dec, std::ios::basefield);
+    output.fill('0');  // keep the stream state as with previous stream formatting
+    if (json) {
+      buffer[length++] = '"';
+    }
+    for (size_t index = 0; index < m_partCount; index++) {
+      if (index > 0) {
+        buffer[length++] = m_type == vt_date ? '.' : ':';
+      }
+      if (m_parts[index] < 0) {
+        buffer[length++] = NULL_VALUE[0];
+      } else {
+        length += formatDecimal(m_parts[index], 0, m_type == vt_date && index == 2 ? 0 : 2, buffer+length,
+            sizeof(buffer)-length-1);  // year without leading zeros
+      }
+    }
+    break;
+  }
+  if (json) {
+    buffer[length++] = '"';
+  }
+  output.write(buffer, static_cast<std::streamsize>(length));
+}
+
+
 bool DataType::dump(ostream& output, const size_t length, const bool appendSeparatorDivisor) const {
   output << m_id;
   if (isAdjustableLength()) {
@@ -57,15 +217,28 @@ bool DataType::dump(ostream& output, const size_t length, const bool appendSepar
   return false;
 }
 
+result_t DataType::readSymbols(const SymbolString& input,
+    const size_t offset, const size_t length,
+    ostringstream& output, OutputFormat outputFormat) const {
+  DataValue value;
+  result_t result = readValue(input, offset, length, value);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  value.format(output, outputFormat);
+  return RESULT_OK;
+}
+
 
 result_t StringDataType::readRawValue(const SymbolString& input, const size_t offset,
     const size_t length, unsigned int& value) const {
   return RESULT_EMPTY;
 }
 
-result_t StringDataType::readSymbols(const SymbolString& input,
+result_t StringDataType::readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const {
+    DataValue& value) const {
+  static const char* hexDigits = "0123456789abcdef";
   size_t start = 0, count = length;
   int incr = 1;
   symbol_t symbol;
@@ -80,17 +253,16 @@ result_t StringDataType::readSymbols(const SymbolString& input,
     incr = -1;
   }
 
-  if (outputFormat & OF_JSON) {
-    output << '"';
-  }
-  output << setfill('0') << (m_isHex ? hex : dec);
+  string str;
+  str.reserve(m_isHex ? count*3 : count);
   for (size_t index = start, i = 0; i < count; index += incr, i++) {
     symbol = input.dataAt(offset + index);
     if (m_isHex) {
       if (i > 0) {
-        output << ' ';
+        str.push_back(' ');
       }
-      output << setw(2) << static_cast<unsigned>(symbol);
+      str.push_back(hexDigits[symbol >> 4]);
+      str.push_back(hexDigits[symbol & 0x0f]);
     } else {
       if (symbol == 0x00) {
         terminated = true;
@@ -99,18 +271,12 @@ result_t StringDataType::readSymbols(const SymbolString& input,
           symbol = (symbol_t)m_replacement;
         } else if (!isprint(symbol)) {
           symbol = '?';
-        } else if (outputFormat & OF_JSON) {
-          if (symbol == '"' || symbol == '\\') {
-            output << '\\';  // escape
-          }
         }
-        output << static_cast<char>(symbol);
+        str.push_back(static_cast<char>(symbol));
       }
     }
   }
-  if (outputFormat & OF_JSON) {
-    output << '"';
-  }
+  value.setString(str);
   return RESULT_OK;
 }
 
@@ -201,9 +367,9 @@ result_t DateTimeDataType::readRawValue(const SymbolString& input, const size_t
   return RESULT_EMPTY;
 }
 
-result_t DateTimeDataType::readSymbols(const SymbolString& input,
+result_t DateTimeDataType::readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const {
+    DataValue& value) const {
   size_t start = 0, count = length;
   int incr = 1;
   symbol_t symbol, last = 0, hour = 0;
@@ -217,37 +383,26 @@ result_t DateTimeDataType::readSymbols(const SymbolString& input,
     incr = -1;
   }
 
-  if (outputFormat & OF_JSON) {
-    output << '"';
-  }
-  int type = (m_hasDate?2:0) | (m_hasTime?1:0);
+  int parts[3] = {-1, -1, -1};
   for (size_t index = start, i = 0; i < count; index += incr, i++) {
     if (length == 4 && i == 2 && m_hasDate) {
       continue;  // skip weekday in between
     }
     symbol = input.dataAt(offset + index);
-    if (hasFlag(BCD) && (hasFlag(REQ) || symbol != m_replacement)) {
+    bool isNull = !hasFlag(REQ) && symbol == m_replacement;
+    if (hasFlag(BCD) && !isNull) {
       if ((symbol & 0xf0) > 0x90 || (symbol & 0x0f) > 0x09) {
         return RESULT_ERR_OUT_OF_RANGE;  // invalid BCD
       }
       symbol = (symbol_t)((symbol >> 4) * 10 + (symbol & 0x0f));
     }
-    switch (type) {
-    case 2:  // date only
-      if (!hasFlag(REQ) && symbol == m_replacement) {
-        if (i + 1 != length) {
-          output << NULL_VALUE << ".";
-          break;
-        } else if (last == m_replacement) {
-          if (length == 2) {  // number of days since 01.01.1900
-            output << NULL_VALUE << ".";
-          }
-          output << NULL_VALUE;
-          break;
-        }
-      }
+    if (m_hasDate) {
       if (length == 2) {  // number of days since 01.01.1900
         if (i == 0) {
+          last = symbol;
+          continue;
+        }
+        if (isNull && last == m_replacement) {
           break;
         }
         int mjd = last + symbol*256 + 15020;  // 01.01.1900
@@ -259,76 +414,76 @@ result_t DateTimeDataType::readSymbols(const SymbolString& input,
           y++;
           m -= 12;
         }
-        output << dec << setfill('0') << setw(2) << static_cast<unsigned>(d) << "."
-            << setw(2) << static_cast<unsigned>(m) << "." << static_cast<unsigned>(y + 1900);
+        parts[0] = d;
+        parts[1] = m;
+        parts[2] = y + 1900;
         break;
       }
       if (i + 1 == length) {
-        output << (2000 + symbol);
+        if (!isNull || last != m_replacement) {
+          parts[2] = 2000 + symbol;
+        }
+      } else if (isNull) {
+        // keep part unset
       } else if (symbol < 1 || (i == 0 && symbol > 31) || (i == 1 && symbol > 12)) {
         return RESULT_ERR_OUT_OF_RANGE;  // invalid date
       } else {
-        output << setw(2) << dec << setfill('0') << static_cast<unsigned>(symbol) << ".";
+        parts[i] = symbol;
+      }
+      last = symbol;
+      continue;
+    }
+    if (hasFlag(SPE)) {  // minutes since midnight
+      if (i == 0) {
+        last = symbol;
+        continue;
       }
+      if (isNull) {  // only the high byte marks the replacement, as the low byte alone may be a valid value
+        break;
+      }
+      int minutes = symbol*256 + last;
+      if (minutes > 24*60) {
+        return RESULT_ERR_OUT_OF_RANGE;  // invalid value
+      }
+      parts[0] = minutes / 60;
+      parts[1] = minutes % 60;
       break;
-
-    case 1:  // time only
-      if (!hasFlag(REQ) && symbol == m_replacement) {
-        if (length == 1) {  // truncated time
-          output << NULL_VALUE << ":" << NULL_VALUE;
-          break;
-        }
-        if (i > 0) {
-          output << ":";
-        }
-        output << NULL_VALUE;
+    }
+    if (isNull) {
+      if (length == 1) {  // truncated time
         break;
       }
-      if (hasFlag(SPE)) {  // minutes since midnight
-        if (i == 0) {
-          last = symbol;
-          continue;
-        }
-        int minutes = symbol*256 + last;
-        if (minutes > 24*60) {
-          return RESULT_ERR_OUT_OF_RANGE;  // invalid value
-        }
-        int hour = minutes / 60;
-        if (hour > 24) {
-          return RESULT_ERR_OUT_OF_RANGE;  // invalid hour
-        }
-        output << setw(2) << dec << setfill('0') << static_cast<unsigned>(hour);
-        symbol = (symbol_t)(minutes % 60);
-      } else if (length == 1) {  // truncated time
-        if (m_bitCount < 8) {
-          symbol = (symbol_t)(symbol & ((1 << m_bitCount) - 1));
-        }
-        if (i == 0) {
-          symbol = (symbol_t)(symbol/(60/m_resolution));  // convert to hours
-          index -= incr;  // repeat for minutes
-          count++;
-        } else {
-          symbol = (symbol_t)((symbol % (60/m_resolution)) * m_resolution);  // convert to minutes
-        }
+      continue;  // keep part unset
+    }
+    if (length == 1) {  // truncated time
+      if (m_bitCount < 8) {
+        symbol = (symbol_t)(symbol & ((1 << m_bitCount) - 1));
       }
-      if (i == 0) {
-        if (symbol > 24) {
-          return RESULT_ERR_OUT_OF_RANGE;  // invalid hour
-        }
-        hour = symbol;
-      } else if (symbol > 59 || (hour == 24 && symbol > 0)) {
+      hour = (symbol_t)(symbol/(60/m_resolution));  // convert to hours
+      symbol = (symbol_t)((symbol % (60/m_resolution)) * m_resolution);  // convert to minutes
+      if (hour > 24 || symbol > 59 || (hour == 24 && symbol > 0)) {
         return RESULT_ERR_OUT_OF_RANGE;  // invalid time
       }
-      if (i > 0) {
-        output << ":";
-      }
-      output << setw(2) << dec << setfill('0') << static_cast<unsigned>(symbol);
+      parts[0] = hour;
+      parts[1] = symbol;
       break;
     }
-    last = symbol;
+    if (i == 0) {
+      if (symbol > 24) {
+        return RESULT_ERR_OUT_OF_RANGE;  // invalid hour
+      }
+      hour = symbol;
+    } else if (symbol > 59 || (hour == 24 && symbol > 0)) {
+      return RESULT_ERR_OUT_OF_RANGE;  // invalid time
+    }
+    parts[i] = symbol;
   }
-  if (outputFormat & OF_JSON) {
-    output << '"';
+  if (m_hasDate) {
+    value.setDate(parts[0], parts[1], parts[2]);
+  } else if (length == 3) {
+    value.setTime(parts[0], parts[1], parts[2]);
+  } else {
+    value.setTime(parts[0], parts[1]);
   }
   return RESULT_OK;
 }
@@ -628,114 +783,102 @@ result_t NumberDataType::readRawValue(const SymbolString& input,
   return RESULT_OK;
 }
 
-result_t NumberDataType::readSymbols(const SymbolString& input,
-    const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const {
-  unsigned int value = 0;
-  int signedValue;
+/**
+ * Decode an IEEE 754 binary32 raw value.
+ * @param value the raw value.
+ * @param negative whether the sign bit is set.
+ * @return the decoded value.
+ */
+static float decodeFloat(unsigned int value, bool negative) {
+  float val;
+#ifdef HAVE_DIRECT_FLOAT_FORMAT
+#  if HAVE_DIRECT_FLOAT_FORMAT == 2
+  value = __builtin_bswap32(value);
+#  endif
+  symbol_t* pval = reinterpret_cast<symbol_t*>(&value);
+  val = *reinterpret_cast<float*>(pval);
+#else
+  int exp = (value >> 23) & 0xff;  // 8 bits, signed
+  if (exp == 0) {
+    val = 0.0;
+  } else {
+    exp -= 127;
+    unsigned int sig = value & ((1 << 23) - 1);
+    val = (1.0f + static_cast<float>(sig / exp2(23))) * static_cast<float>(exp2(exp));
+    if (negative) {
+      val = -val;
+    }
+  }
+#endif
+  return val;
+}
+
+/** the powers of ten up to @a MAX_DIVISOR. */
+static const int powersOfTen[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
 
-  result_t result = readRawValue(input, offset, length, value);
+result_t NumberDataType::readValue(const SymbolString& input,
+    const size_t offset, const size_t length,
+    DataValue& value) const {
+  unsigned int rawValue = 0;
+  result_t result = readRawValue(input, offset, length, rawValue);
   if (result != RESULT_OK) {
     return result;
   }
-  output << setw(0) << dec;  // initialize output
-
-  if (!hasFlag(REQ) && value == m_replacement) {
-    if (outputFormat & OF_JSON) {
-      output << "null";
-    } else {
-      output << NULL_VALUE;
-    }
+  if (!hasFlag(REQ) && rawValue == m_replacement) {
+    value.setNull();
     return RESULT_OK;
   }
 
-  bool negative;
+  bool negative = false;
   if (hasFlag(SIG)) {  // signed value
-    negative = (value & (1 << (m_bitCount - 1))) != 0;
-    if (negative) {  // negative signed value
-      if (value < m_minValue) {
-        return RESULT_ERR_OUT_OF_RANGE;  // value out of range
-      }
-    } else if (value > m_maxValue) {
+    negative = (rawValue & (1u << (m_bitCount - 1))) != 0;
+    if (negative ? rawValue < m_minValue : rawValue > m_maxValue) {
       return RESULT_ERR_OUT_OF_RANGE;  // value out of range
     }
-  } else if (value < m_minValue || value > m_maxValue) {
+  } else if (rawValue < m_minValue || rawValue > m_maxValue) {
     return RESULT_ERR_OUT_OF_RANGE;  // value out of range
-  } else {
-    negative = false;
   }
-  if (m_bitCount == 32) {
-    if (hasFlag(EXP)) {  // IEEE 754 binary32
-      float val;
-#ifdef HAVE_DIRECT_FLOAT_FORMAT
-#  if HAVE_DIRECT_FLOAT_FORMAT == 2
-      value = __builtin_bswap32(value);
-#  endif
-      symbol_t* pval = reinterpret_cast<symbol_t*>(&value);
-      val = *reinterpret_cast<float*>(pval);
-#else
-      int exp = (value >> 23) & 0xff;  // 8 bits, signed
-      if (exp == 0) {
-        val = 0.0;
-      } else {
-        exp -= 127;
-        unsigned int sig = value & ((1 << 23) - 1);
-        val = (1.0f + static_cast<float>(sig / exp2(23))) * static_cast<float>(exp2(exp));
-        if (negative) {
-          val = -val;
-        }
-      }
-#endif
-      if (val != 0.0) {
-        if (m_divisor < 0) {
-          val *= static_cast<float>(-m_divisor);
-        } else if (m_divisor > 1) {
-          val /= static_cast<float>(m_divisor);
-        }
-      }
-      if (m_precision != 0) {
-        output << fixed << setprecision(static_cast<int>(m_precision+6));
-      } else if (val == 0) {
-        output << fixed << setprecision(1);
-      }
-      output << static_cast<double>(val);
-      return RESULT_OK;
-    }
-    if (!negative) {
+  if (m_bitCount == 32 && hasFlag(EXP)) {  // IEEE 754 binary32
+    double val = static_cast<double>(decodeFloat(rawValue, negative));
+    if (val != 0.0) {
       if (m_divisor < 0) {
-        output << (static_cast<float>(value) * static_cast<float>(-m_divisor));
-      } else if (m_divisor <= 1) {
-        output << static_cast<unsigned>(value);
-      } else {
-        output << setprecision(static_cast<int>(m_precision))
-               << fixed << (static_cast<float>(value) / static_cast<float>(m_divisor));
+        val *= static_cast<double>(-m_divisor);
+      } else if (m_divisor > 1) {
+        val /= static_cast<double>(m_divisor);
       }
-      return RESULT_OK;
     }
-    signedValue = static_cast<int>(value);  // negative signed value
-  } else if (negative) {  // negative signed value
-    signedValue = static_cast<int>(value) - (1 << m_bitCount);
+    value.setFloat(val, m_precision != 0 ? static_cast<int>(m_precision+6) : val == 0 ? 1 : -1);
+    return RESULT_OK;
+  }
+  int64_t signedValue;
+  if (!negative) {
+    signedValue = rawValue;
+  } else if (m_bitCount == 32) {
+    signedValue = static_cast<int>(rawValue);
   } else {
-    signedValue = static_cast<int>(value);
+    signedValue = static_cast<int>(rawValue) - (1 << m_bitCount);
   }
   if (m_divisor < 0) {
-    output << fixed << setprecision(0)
-        << (static_cast<float>(signedValue) * static_cast<float>(-m_divisor));
+    value.setInteger(signedValue * -m_divisor);
   } else if (m_divisor <= 1) {
-    if (hasFlag(FIX) && hasFlag(BCD)) {
-      if (outputFormat & OF_JSON) {
-        output << '"';
-        output << setw(static_cast<int>(length * 2)) << setfill('0');
-        output << static_cast<signed>(signedValue) << setw(0);
-        output << '"';
+    value.setInteger(signedValue, hasFlag(FIX) && hasFlag(BCD) ? length * 2 : 0);
+  } else {
+    // divided in single precision like the value range of the types
+    double val = static_cast<float>(signedValue) / static_cast<float>(m_divisor);
+    if (m_precision < sizeof(powersOfTen)/sizeof(powersOfTen[0]) && signedValue > -(1 << 23)
+        && signedValue < (1 << 23) && (m_divisor == powersOfTen[m_precision] || (m_divisor & (m_divisor-1)) == 0)) {
+      // the single precision value is exact (or rounds back to it), so round the decimal half to even like printf
+      int64_t scaled = (signedValue < 0 ? -signedValue : signedValue) * powersOfTen[m_precision];
+      int64_t quotient = scaled / m_divisor, remainder = scaled % m_divisor;
+      if (remainder * 2 > m_divisor || (remainder * 2 == m_divisor && (quotient & 1) != 0)) {
+        quotient++;
+      }
+      if (quotient != 0 || signedValue >= 0) {
+        value.setDecimal(val, signedValue < 0 ? -quotient : quotient, static_cast<int>(m_precision));
         return RESULT_OK;
       }
-      output << setw(static_cast<int>(length * 2)) << setfill('0');
     }
-    output << static_cast<signed>(signedValue) << setw(0);
-  } else {
-    output << setprecision(static_cast<int>(m_precision))
-           << fixed << (static_cast<float>(signedValue) / static_cast<float>(m_divisor));
+    value.setFloat(val, static_cast<int>(m_precision));
   }
   return RESULT_OK;
 }
@@ -44,9 +44,10 @@ namespace ebusd {
  * using one of these base data types with certain flags, such as #BCD, #FIX,
  * #REQ, see @a DataType.
  *
- * Each @a DataType can be converted from a @a SymbolString to an
- * @a ostringstream (see @a DataType#readSymbols() methods) or vice versa from
- * an @a istringstream to a @a SymbolString (see @a DataType#writeSymbols()).
+ * Each @a DataType can be converted from a @a SymbolString to a typed
+ * @a DataValue (see @a DataType#readValue() methods) that is formatted to an
+ * @a ostringstream (see @a DataType#readSymbols()) or vice versa from an
+ * @a istringstream to a @a SymbolString (see @a DataType#writeSymbols()).
  */
 
 using std::map;
@@ -151,6 +152,239 @@ enum PartType {
 #define CON 0x1000
 
 
+/**
+ * Append the value as quoted JSON string to the output with all necessary characters escaped.
+ * @param output the @a ostream to append to.
+ * @param value the value to append.
+ */
+void appendJsonString(ostream& output, const string& value);
+
+
+/**
+ * Format a fixed point decimal value into the buffer without stream formatting.
+ * @param value the value multiplied by 10^precision.
+ * @param precision the number of digits after the decimal point.
+ * @param width the minimum number of characters to fill up with leading zeros, or 0.
+ * @param buffer the buffer to write to.
+ * @param size the size of the buffer.
+ * @return the number of characters written, or 0 if the buffer is too small.
+ */
+size_t formatDecimal(int64_t value, size_t precision, size_t width, char* buffer, size_t size);
+
+
+/** the type of a decoded @a DataValue. */
+enum ValueType {
+  vt_null,     //!< no value (replacement value)
+  vt_integer,  //!< integer value (optionally with assigned text)
+  vt_float,    //!< floating point value
+  vt_string,   //!< string value
+  vt_date,     //!< date value with day, month, and year
+  vt_time,     //!< time value with hour, minute, and optional second
+};
+
+
+/**
+ * A typed value decoded from a @a SymbolString (see @a DataType#readValue()).
+ */
+class DataValue {
+ public:
+  /**
+   * Constructs a new null instance.
+   */
+  DataValue() : m_type(vt_null), m_integer(0), m_float(0), m_precision(0), m_decimal(false), m_width(0),
+    m_partCount(0) {}
+
+  /**
+   * Set to no value.
+   */
+  void setNull() { m_type = vt_null; m_text.clear(); }
+
+  /**
+   * Set an integer value.
+   * @param value the integer value.
+   * @param width the number of digits to fill up with leading zeros (formatted as string), or 0.
+   */
+  void setInteger(int64_t value, size_t width = 0) {
+    m_type = vt_integer;
+    m_integer = value;
+    m_width = width;
+    m_text.clear();
+  }
+
+  /**
+   * Set an integer value with assigned text.
+   * @param value the integer value.
+   * @param text the assigned text (used for formatting unless @a OF_NUMERIC is requested).
+   */
+  void setInteger(int64_t value, const string& text) {
+    setInteger(value);
+    m_text = text;
+  }
+
+  /**
+   * Set a floating point value.
+   * @param value the floating point value.
+   * @param precision the number of fixed point digits for formatting, or -1 to keep the current stream format.
+   */
+  void setFloat(double value, int precision) {
+    m_type = vt_float;
+    m_float = value;
+    m_precision = precision;
+    m_decimal = false;
+    m_text.clear();
+  }
+
+  /**
+   * Set a floating point value together with its decimal representation rounded to the precision.
+   * @param value the floating point value.
+   * @param scaled the value multiplied by 10^precision and rounded.
+   * @param precision the number of digits after the decimal point.
+   */
+  void setDecimal(double value, int64_t scaled, int precision) {
+    setFloat(value, precision);
+    m_integer = scaled;
+    m_decimal = true;
+  }
+
+  /**
+   * Set a string value.
+   * @param value the string value.
+   */
+  void setString(const string& value) {
+    m_type = vt_string;
+    m_text = value;
+  }
+
+  /**
+   * Set a date value.
+   * @param day the day of month, or -1 if not set.
+   * @param month the month, or -1 if not set.
+   * @param year the year, or -1 if not set.
+   */
+  void setDate(int day, int month, int year) {
+    setParts(vt_date, day, month, year, 3);
+  }
+
+  /**
+   * Set a time value without seconds.
+   * @param hour the hour, or -1 if not set.
+   * @param minute the minute, or -1 if not set.
+   */
+  void setTime(int hour, int minute) {
+    setParts(vt_time, hour, minute, -1, 2);
+  }
+
+  /**
+   * Set a time value with seconds.
+   * @param hour the hour, or -1 if not set.
+   * @param minute the minute, or -1 if not set.
+   * @param second the second, or -1 if not set.
+   */
+  void setTime(int hour, int minute, int second) {
+    setParts(vt_time, hour, minute, second, 3);
+  }
+
+  /**
+   * @return the @a ValueType.
+   */
+  ValueType getType() const { return m_type; }
+
+  /**
+   * @return whether no value is set.
+   */
+  bool isNull() const { return m_type == vt_null; }
+
+  /**
+   * @return whether an integer or floating point value is set.
+   */
+  bool isNumeric() const { return m_type == vt_integer || m_type == vt_float; }
+
+  /**
+   * @return the integer value (truncated for floating point values), or 0 for non-numeric values.
+   */
+  int64_t getInteger() const {
+    return m_type == vt_integer ? m_integer : m_type == vt_float ? static_cast<int64_t>(m_float) : 0;
+  }
+
+  /**
+   * @return the floating point value (converted for integer values), or 0 for non-numeric values.
+   */
+  double getFloat() const {
+    return m_type == vt_float ? m_float : m_type == vt_integer ? static_cast<double>(m_integer) : 0;
+  }
+
+  /**
+   * @return the string value, or the text assigned to the integer value, or empty.
+   */
+  const string& getText() const { return m_text; }
+
+  /**
+   * @return the number of date or time parts.
+   */
+  size_t getPartCount() const { return m_partCount; }
+
+  /**
+   * Get a date or time part.
+   * @param index the index of the part (day, month, year for dates, hour, minute, second for times).
+   * @return the part value, or -1 if not set.
+   */
+  int getPart(size_t index) const { return index < m_partCount ? m_parts[index] : -1; }
+
+  /**
+   * Format the value to the output.
+   * @param output the @a ostream to append the formatted value to.
+   * @param outputFormat the @a OutputFormat options to use.
+   */
+  void format(ostream& output, OutputFormat outputFormat) const;
+
+
+ private:
+  /**
+   * Set a date or time value.
+   * @param type the @a ValueType.
+   * @param part0 the first part, or -1 if not set.
+   * @param part1 the second part, or -1 if not set.
+   * @param part2 the third part, or -1 if not set.
+   * @param count the number of parts.
+   */
+  void setParts(ValueType type, int part0, int part1, int part2, size_t count) {
+    m_type = type;
+    m_parts[0] = part0;
+    m_parts[1] = part1;
+    m_parts[2] = part2;
+    m_partCount = count;
+    m_text.clear();
+  }
+
+  /** the @a ValueType. */
+  ValueType m_type;
+
+  /** the integer value. */
+  int64_t m_integer;
+
+  /** the floating point value. */
+  double m_float;
+
+  /** the number of fixed point digits for formatting the floating point value, or -1. */
+  int m_precision;
+
+  /** whether the integer value holds the floating point value multiplied by 10^precision and rounded. */
+  bool m_decimal;
+
+  /** the number of digits to fill up the integer value with leading zeros, or 0. */
+  size_t m_width;
+
+  /** the string value, or the text assigned to the integer value. */
+  string m_text;
+
+  /** the date or time parts. */
+  int m_parts[3];
+
+  /** the number of date or time parts. */
+  size_t m_partCount;
+};
+
+
 /**
  * Base class for all kinds of data types.
  */
@@ -233,7 +467,19 @@ class DataType {
     unsigned int& value) const = 0;
 
   /**
-   * Internal method for reading the field from a @a SymbolString.
+   * Internal method for reading the typed value from a @a SymbolString.
+   * @param input the @a SymbolString to read the binary value from.
+   * @param offset the offset in the data of the @a SymbolString.
+   * @param length the number of symbols to read.
+   * @param value the @a DataValue in which to store the decoded value.
+   * @return @a RESULT_OK on success, or an error code.
+   */
+  virtual result_t readValue(const SymbolString& input,
+    const size_t offset, const size_t length,
+    DataValue& value) const = 0;
+
+  /**
+   * Internal method for reading the field from a @a SymbolString (formatted from @a readValue()).
    * @param input the @a SymbolString to read the binary value from.
    * @param offset the offset in the data of the @a SymbolString.
    * @param length the number of symbols to read.
@@ -241,9 +487,9 @@ class DataType {
    * @param outputFormat the @a OutputFormat options to use.
    * @return @a RESULT_OK on success, or an error code.
    */
-  virtual result_t readSymbols(const SymbolString& input,
+  result_t readSymbols(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const = 0;
+    ostringstream& output, OutputFormat outputFormat) const;
 
   /**
    * Internal method for writing the field to a @a SymbolString.
@@ -303,9 +549,9 @@ class StringDataType : public DataType {
     unsigned int& value) const override;
 
   // @copydoc
-  result_t readSymbols(const SymbolString& input,
+  result_t readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const override;
+    DataValue& value) const override;
 
   // @copydoc
   result_t writeSymbols(istringstream& input,
@@ -365,9 +611,9 @@ class DateTimeDataType : public DataType {
     unsigned int& value) const override;
 
   // @copydoc
-  result_t readSymbols(const SymbolString& input,
+  result_t readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const override;
+    DataValue& value) const override;
 
   // @copydoc
   result_t writeSymbols(istringstream& input,
@@ -483,9 +729,9 @@ class NumberDataType : public DataType {
     unsigned int& value) const override;
 
   // @copydoc
-  result_t readSymbols(const SymbolString& input,
+  result_t readValue(const SymbolString& input,
     const size_t offset, const size_t length,
-    ostringstream& output, OutputFormat outputFormat) const override;
+    DataValue& value) const override;
 
   /**
    * Internal method for writing the numeric raw value to a @a SymbolString.
@@ -108,6 +108,10 @@ string getMessageFieldName(const string name, bool& supportsLanguage) {
     return withDataFields ? "fields" : "";
   */
 
+MessageListener* Message::s_listener = NULL;
+
+std::atomic<unsigned int> Message::s_lastChangeSequence(0);
+
 Message::Message(const string circuit, const string level, const string name,
     const bool isWrite, const bool isPassive, const map<string, string>& attributes,
     const symbol_t srcAddress, const symbol_t dstAddress,
@@ -122,7 +126,9 @@ Message::Message(const string circuit, const string level, const string name,
       m_data(data), m_deleteData(deleteData),
       m_pollPriority(pollPriority),
       m_usedByCondition(false), m_isScanMessage(false), m_condition(condition),
-      m_lastUpdateTime(0), m_lastChangeTime(0), m_pollCount(0), m_lastPollTime(0) {
+      m_lastUpdateTime(0), m_lastChangeTime(0), m_lastChangeSequence(++s_lastChangeSequence),
+      m_updateCount(0), m_pollCount(0),
+      m_lastPollTime(0) {
   if (circuit == "scan") {
     setScanMessage();
     m_pollPriority = 0;
@@ -139,7 +145,9 @@ Message::Message(const string circuit, const string level, const string name,
       m_data(data), m_deleteData(deleteData),
       m_pollPriority(0),
       m_usedByCondition(false), m_isScanMessage(true), m_condition(NULL),
-      m_lastUpdateTime(0), m_lastChangeTime(0), m_pollCount(0), m_lastPollTime(0) {
+      m_lastUpdateTime(0), m_lastChangeTime(0), m_lastChangeSequence(++s_lastChangeSequence),
+      m_updateCount(0), m_pollCount(0),
+      m_lastPollTime(0) {
 }
 
 
@@ -693,9 +701,14 @@ result_t Message::prepareSlave(istringstream& input, SlaveSymbolString& slave) {
   }
   slave.adjustHeader();
   time(&m_lastUpdateTime);
+  m_updateCount++;
   if (slave != m_lastSlaveData) {
     m_lastChangeTime = m_lastUpdateTime;
+    m_lastChangeSequence = ++s_lastChangeSequence;
     m_lastSlaveData = slave;
+    if (s_listener) {
+      s_listener->notifyMessageChanged(this);
+    }
   }
   return result;
 }
@@ -712,11 +725,18 @@ result_t Message::storeLastData(MasterSymbolString& data, size_t index) {
   if (data.size() > 0 && (m_isWrite || this->m_dstAddress == BROADCAST || isMaster(this->m_dstAddress)
       || data.getDataSize() + 2 > m_id.size())) {
     time(&m_lastUpdateTime);
+    if (data.size() > 1 && (data[1] == BROADCAST || isMaster(data[1]))) {
+      m_updateCount++;  // no slave part
+    }
   }
   switch (data.compareTo(m_lastMasterData)) {
   case 1:  // completely different
     m_lastChangeTime = m_lastUpdateTime;
+    m_lastChangeSequence = ++s_lastChangeSequence;
     m_lastMasterData = data;
+    if (s_listener) {
+      s_listener->notifyMessageChanged(this);
+    }
     break;
   case 2:  // only master address is different
     m_lastMasterData = data;
@@ -729,10 +749,15 @@ result_t Message::storeLastData(MasterSymbolString& data, size_t index) {
 result_t Message::storeLastData(SlaveSymbolString& data, size_t index) {
   if (data.size() > 0) {
     time(&m_lastUpdateTime);
+    m_updateCount++;
   }
   if (data != m_lastSlaveData) {
     m_lastChangeTime = m_lastUpdateTime;
+    m_lastChangeSequence = ++s_lastChangeSequence;
     m_lastSlaveData = data;
+    if (s_listener) {
+      s_listener->notifyMessageChanged(this);
+    }
   }
   return RESULT_OK;
 }
@@ -786,6 +811,44 @@ result_t Message::decodeLastData(ostringstream& output, OutputFormat outputForma
   return result;
 }
 
+result_t Message::decodeLastDataFields(ostringstream& output, OutputFormat outputFormat, bool leadingSeparator,
+    const vector<string>& fields) const {
+  bool found = false;
+  for (const auto& field : fields) {
+    const char* fieldName = field.c_str();
+    ssize_t fieldIndex = -1;
+    string name;
+    size_t pos = field.rfind('.');
+    if (pos != string::npos && pos > 0 && pos+1 < field.length()) {
+      char* strEnd = NULL;
+      unsigned long int index = strtoul(field.c_str()+pos+1, &strEnd, 10);
+      if (strEnd != NULL && *strEnd == 0) {
+        name = field.substr(0, pos);
+        fieldName = name.c_str();
+        fieldIndex = static_cast<ssize_t>(index);
+      }
+    }
+    std::streampos startPos = output.tellp();
+    result_t result = decodeLastData(output, outputFormat, leadingSeparator || found, fieldName, fieldIndex);
+    if (result == RESULT_ERR_NOTFOUND) {
+      continue;
+    }
+    if (result < RESULT_OK) {
+      return result;
+    }
+    found |= output.tellp() != startPos;
+  }
+  return found ? RESULT_OK : RESULT_EMPTY;
+}
+
+result_t Message::decodeLastDataValues(vector<DataValue>& values, vector<string>* names) const {
+  result_t result = m_data->readValues(m_lastMasterData, getIdLength(), values, names);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  return m_data->readValues(m_lastSlaveData, 0, values, names);
+}
+
 result_t Message::decodeLastDataNumField(unsigned int& output, const char* fieldName, ssize_t fieldIndex) const {
   result_t result = m_data->read(m_lastMasterData, getIdLength(), output, fieldName, fieldIndex);
   if (result < RESULT_OK) {
@@ -943,15 +1006,19 @@ void Message::decode(ostringstream& output, OutputFormat outputFormat, bool lead
   if (leadingSeparator) {
     output << ",";
   }
-  output << "\n  \"" << getName() << "\": {";
+  output << "\n  ";
+  appendJsonString(output, getName());
+  output << ": {";
   output << "\n   \"lastup\": " << setw(0) << dec << static_cast<unsigned>(getLastUpdateTime());
   if (getLastUpdateTime() != 0) {
-    output << ",\n   \"zz\": \"" << setfill('0') << setw(2) << hex << static_cast<unsigned>(getDstAddress()) << "\"";
+    output << ",\n   \"zz\": \"" << setfill('0') << setw(2) << hex << static_cast<unsigned>(getDstAddress())
+        << "\"" << dec;
     appendAttributes(output, OF_JSON | outputFormat);
     size_t pos = (size_t) output.tellp();
     output << ",\n   \"fields\": {";
-    result_t dret = decodeLastData(output, outputFormat);
-    if (dret == RESULT_OK) {
+    result_t dret = fields ? decodeLastDataFields(output, outputFormat, false, *fields)
+        : decodeLastData(output, outputFormat);
+    if (dret >= RESULT_OK) {
       output << "\n   }";
     } else {
       string prefix = output.str().substr(0, pos);
@@ -2378,64 +2445,155 @@ Message* MessageMap::find(const string& circuit, const string& name, const strin
   return NULL;
 }
 
+MessagePatterns::~MessagePatterns() {
+  for (auto pattern : m_includes) {
+    regfree(pattern);
+    delete pattern;
+  }
+  for (auto pattern : m_excludes) {
+    regfree(pattern);
+    delete pattern;
+  }
+}
+
+result_t MessagePatterns::add(const string& pattern, bool exclude) {
+  regex_t* compiled = new regex_t;
+  if (regcomp(compiled, pattern.c_str(), REG_EXTENDED|REG_NOSUB) != 0) {
+    delete compiled;
+    return RESULT_ERR_INVALID_ARG;
+  }
+  (exclude ? m_excludes : m_includes).push_back(compiled);
+  return RESULT_OK;
+}
+
+bool MessagePatterns::matches(const char* subject) const {
+  bool included = m_includes.empty();
+  for (auto pattern : m_includes) {
+    if (regexec(pattern, subject, 0, NULL, 0) == 0) {
+      included = true;
+      break;
+    }
+  }
+  if (!included) {
+    return false;
+  }
+  for (auto pattern : m_excludes) {
+    if (regexec(pattern, subject, 0, NULL, 0) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Check whether a part of a name key matches the lower case search string.
+ * @param key the name key to check.
+ * @param start the start position of the part in the key.
+ * @param length the length of the part in the key.
+ * @param search the lower case string to search for.
+ * @param completeMatch true to require the part to equal @p search, false to require it to contain @p search only.
+ * @return true when the part matches.
+ */
+static bool matchKeyPart(const string& key, size_t start, size_t length, const string& search,
+    const bool completeMatch) {
+  if (completeMatch) {
+    return length == search.length() && key.compare(start, length, search) == 0;
+  }
+  size_t pos = key.find(search, start);
+  return pos != string::npos && pos + search.length() <= start + length;
+}
+
+/**
+ * Check whether the @a Message matches the specified criteria.
+ * @param message the @a Message to check.
+ * @param lcircuit the lower case circuit name, or empty for any.
+ * @param lname the lower case message name, or empty for any.
+ * @see MessageMap#findAll() for the remaining parameters.
+ * @return true when the @a Message matches.
+ */
+static bool matchMessage(Message* message, const string& lcircuit, const string& lname, const string& levels,
+    const bool completeMatch, const bool withRead, const bool withWrite, const bool withPassive,
+    const bool includeEmptyLevel, const bool onlyAvailable,
+    const time_t since, const time_t until) {
+  if (levels != "*" && !message->hasLevel(levels, includeEmptyLevel)) {
+    return false;
+  }
+  if (lcircuit.length() > 0) {
+    string check = message->getCircuit();
+    FileReader::tolower(check);
+    if (completeMatch ? (check != lcircuit) : (check.find(lcircuit) == check.npos)) {
+      return false;
+    }
+  }
+  if (lname.length() > 0) {
+    string check = message->getName();
+    FileReader::tolower(check);
+    if (completeMatch ? (check != lname) : (check.find(lname) == check.npos)) {
+      return false;
+    }
+  }
+  if (message->isPassive()) {
+    if (!withPassive) {
+      return false;
+    }
+  } else if (message->isWrite()) {
+    if (!withWrite) {
+      return false;
+    }
+  } else {
+    if (!withRead) {
+      return false;
+    }
+  }
+  if (since != 0 || until != 0) {
+    if (message->getDstAddress() == SYN) {
+      return false;
+    }
+    time_t lastchg = message->getLastChangeTime();
+    if ((since != 0 && lastchg < since)
+    || (until != 0 && lastchg >= until)) {
+      return false;
+    }
+  }
+  return !onlyAvailable || message->isAvailable();
+}
+
 deque<Message*> MessageMap::findAll(const string& circuit, const string& name, const string& levels,
     const bool completeMatch, const bool withRead, const bool withWrite, const bool withPassive,
     const bool includeEmptyLevel, const bool onlyAvailable,
-    const time_t since, const time_t until) const {
+    const time_t since, const time_t until, const MessagePatterns* patterns) const {
   deque<Message*> ret;
   string lcircuit = circuit;
   FileReader::tolower(lcircuit);
   string lname = name;
   FileReader::tolower(lname);
-  bool checkCircuit = lcircuit.length() > 0;
-  bool checkLevel = levels != "*";
-  bool checkName = lname.length() > 0;
-  for (auto it : m_messagesByName) {
-    if (it.first[0] == FIELD_SEPARATOR) {  // avoid duplicates: instances stored multiple times have a special key
+  if (patterns && patterns->empty()) {
+    patterns = NULL;
+  }
+  string subject;
+  for (const auto& it : m_messagesByName) {
+    // the key is the lower case circuit and name separated by FIELD_SEPARATOR plus a trailing type character
+    const string& key = it.first;
+    if (key[0] == FIELD_SEPARATOR) {  // avoid duplicates: instances stored multiple times have a special key
       continue;
     }
-    for (auto message : it.second) {
-      if (checkLevel && !message->hasLevel(levels, includeEmptyLevel)) {
+    size_t sepPos = key.find(FIELD_SEPARATOR);
+    if (!lcircuit.empty() && !matchKeyPart(key, 0, sepPos, lcircuit, completeMatch)) {
+      continue;
+    }
+    if (!lname.empty() && !matchKeyPart(key, sepPos+1, key.length()-sepPos-2, lname, completeMatch)) {
+      continue;
+    }
+    if (patterns) {
+      const Message* first = it.second.front();
+      subject.assign(first->getCircuit()).append(1, ':').append(first->getName());
+      if (!patterns->matches(subject.c_str())) {
         continue;
       }
-      if (checkCircuit) {
-        string check = message->getCircuit();
-        FileReader::tolower(check);
-        if (completeMatch ? (check != lcircuit) : (check.find(lcircuit) == check.npos)) {
-          continue;
-        }
-      }
-      if (checkName) {
-        string check = message->getName();
-        FileReader::tolower(check);
-        if (completeMatch ? (check != lname) : (check.find(lname) == check.npos)) {
-          continue;
-        }
-      }
-      if (message->isPassive()) {
-        if (!withPassive) {
-          continue;
-        }
-      } else if (message->isWrite()) {
-        if (!withWrite) {
-          continue;
-        }
-      } else {
-        if (!withRead) {
-          continue;
-        }
-      }
-      if (since != 0 || until != 0) {
-        if (message->getDstAddress() == SYN) {
-          continue;
-        }
-        time_t lastchg = message->getLastChangeTime();
-        if ((since != 0 && lastchg < since)
-        || (until != 0 && lastchg >= until)) {
-          continue;
-        }
-      }
-      if (!onlyAvailable || message->isAvailable()) {
+    }
+    for (auto message : it.second) {
+      if (matchMessage(message, "", "", levels, completeMatch, withRead, withWrite, withPassive,
+          includeEmptyLevel, onlyAvailable, since, until)) {
         ret.push_back(message);
       }
     }
@@ -2444,6 +2602,18 @@ deque<Message*> MessageMap::findAll(const string& circuit, const string& name, c
   return ret;
 }
 
+bool MessageMap::matches(Message* message, const string& circuit, const string& name, const string& levels,
+    const bool completeMatch, const bool withRead, const bool withWrite, const bool withPassive,
+    const bool includeEmptyLevel, const bool onlyAvailable,
+    const time_t since, const time_t until) const {
+  string lcircuit = circuit;
+  FileReader::tolower(lcircuit);
+  string lname = name;
+  FileReader::tolower(lname);
+  return matchMessage(message, lcircuit, lname, levels, completeMatch, withRead, withWrite, withPassive,
+      includeEmptyLevel, onlyAvailable, since, until);
+}
+
 Message* MessageMap::find(MasterSymbolString& master, bool anyDestination,
   const bool withRead, const bool withWrite, const bool withPassive, const bool onlyAvailable) const {
   if (anyDestination && master.size() >= 5 && master[4] == 0 && master[2] == 0x07 && master[3] == 0x04) {
@@ -2522,6 +2692,7 @@ void MessageMap::invalidateCache(Message* message) {
     return;
   }
   message->m_lastUpdateTime = 0;
+  message->m_lastChangeSequence = ++Message::s_lastChangeSequence;
   string circuit = message->getCircuit();
   string name = message->getName();
   deque<Message*> messages = findAll(circuit, name, "*", true, true, true, true);
@@ -2529,6 +2700,7 @@ void MessageMap::invalidateCache(Message* message) {
     Message* checkMessage = *it;
     if (checkMessage != message) {
       checkMessage->m_lastUpdateTime = 0;
+      checkMessage->m_lastChangeSequence = ++Message::s_lastChangeSequence;
     }
   }
 }
@@ -2546,7 +2718,8 @@ bool MessageMap::decodeCircuit(const string circuit, ostringstream& output, Outp
     return false;
   }
   if (outputFormat & OF_JSON) {
-    output << "\"name\": \"" << it->second->getName() << "\"";
+    output << "\"name\": ";
+    appendJsonString(output, it->second->getName());
   } else {
     output << it->second->getName() << "=";
   }
@@ -20,6 +20,8 @@
 #define LIB_EBUS_MESSAGE_H_
 
 #include <stdint.h>
+#include <regex.h>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <deque>
@@ -67,6 +69,26 @@ class Condition;
 class SimpleCondition;
 class CombinedCondition;
 class MessageMap;
+class Message;
+
+
+/**
+ * Interface for listening to changes of the last seen data of @a Message instances.
+ */
+class MessageListener {
+ public:
+  /**
+   * Destructor.
+   */
+  virtual ~MessageListener() {}
+
+  /**
+   * Listener method that is called when the last seen data of a @a Message changed.
+   * Note: this is called from within the thread storing the data (e.g. the bus thread).
+   * @param message the @a Message with changed data.
+   */
+  virtual void notifyMessageChanged(Message* message) = 0;  // abstract
+};
 
 
 /**
@@ -274,6 +296,19 @@ class Message : public AttributedItem {
    */
   virtual string getFieldName(const ssize_t fieldIndex) const { return m_data->getName(fieldIndex); }
 
+  /**
+   * Get the number of fields.
+   * @return the number of fields (including ignored ones).
+   */
+  size_t getFieldCount() const { return m_data->getFieldCount(); }
+
+  /**
+   * Get the specified field.
+   * @param fieldIndex the index of the field.
+   * @return the @a SingleDataField, or NULL if not available.
+   */
+  const SingleDataField* getField(const size_t fieldIndex) const { return m_data->getField(fieldIndex); }
+
   /**
    * Get whether this is a write message.
    * @return whether this is a write message.
@@ -492,6 +527,18 @@ class Message : public AttributedItem {
   virtual result_t decodeLastData(ostringstream& output, OutputFormat outputFormat = 0,
       bool leadingSeparator = false, const char* fieldName = NULL, ssize_t fieldIndex = -1) const;
 
+  /**
+   * Decode only the specified fields from the last stored data.
+   * @param output the @a ostringstream to append the formatted values to.
+   * @param outputFormat the @a OutputFormat options to use.
+   * @param leadingSeparator whether to prepend a separator before the first formatted value.
+   * @param fields the names of the fields to limit the output to, each optionally followed by "." and the index of
+   * the field with that name.
+   * @return @a RESULT_OK on success, @a RESULT_EMPTY when none of the fields is present, or an error code.
+   */
+  result_t decodeLastDataFields(ostringstream& output, OutputFormat outputFormat, bool leadingSeparator,
+      const vector<string>& fields) const;
+
   /**
    * Decode a particular numeric field value from the last stored data.
    * @param output the variable in which to store the value.
@@ -501,6 +548,20 @@ class Message : public AttributedItem {
    */
   virtual result_t decodeLastDataNumField(unsigned int& output, const char* fieldName, ssize_t fieldIndex = -1) const;
 
+  /**
+   * Decode the typed values of all fields from the last stored data.
+   * @param values the vector to append the @a DataValue of each field to.
+   * @param names the vector to append the name of each field to, or NULL.
+   * @return @a RESULT_OK on success, or an error code.
+   */
+  result_t decodeLastDataValues(vector<DataValue>& values, vector<string>* names = NULL) const;
+
+  /**
+   * Set the @a MessageListener to notify about changed data of any @a Message.
+   * @param listener the @a MessageListener, or NULL.
+   */
+  static void setListener(MessageListener* listener) { s_listener = listener; }
+
   /**
    * Get the last seen master data.
    * @return the last seen @a MasterSymbolString.
@@ -525,6 +586,18 @@ class Message : public AttributedItem {
    */
   time_t getLastChangeTime() const { return m_lastChangeTime; }
 
+  /**
+   * Get the sequence number of the last change of this message's data or validity.
+   * @return the sequence number of the last change, unique among all @a Message instances (higher is newer).
+   */
+  unsigned int getLastChangeSequence() const { return m_lastChangeSequence; }
+
+  /**
+   * Get the number of times this message was seen with reasonable data.
+   * @return the number of updates of the message data.
+   */
+  unsigned int getUpdateCount() const { return m_updateCount; }
+
   /**
    * Get the time when this message was last polled for.
    * @return the time when this message was last polled for, or 0 for never.
@@ -566,7 +639,7 @@ class Message : public AttributedItem {
    * @param output the @a ostringstream to append the decoded value(s) to.
    * @param outputFormat the @a OutputFormat options to use.
    * @param leadingSeparator whether to prepend a separator before the first value.
-   * @param fields the list of message and/or data field fields to write, or NULL for all.
+   * @param fields the list of data fields to write (see @a decodeLastDataFields()), or NULL for all.
    */
   virtual void decode(ostringstream& output, OutputFormat outputFormat = 0, bool leadingSeparator = false,
       vector<string>* fields = NULL) const;
@@ -647,11 +720,23 @@ class Message : public AttributedItem {
   /** the system time when the message content was last changed, 0 for never. */
   time_t m_lastChangeTime;
 
+  /** the sequence number of the last change of the message content or validity (or of the creation). */
+  unsigned int m_lastChangeSequence;
+
+  /** the number of times the message data was updated. */
+  unsigned int m_updateCount;
+
   /** the number of times this messages was already polled for. */
   unsigned int m_pollCount;
 
   /** the system time when this message was last polled for, 0 for never. */
   time_t m_lastPollTime;
+
+  /** the @a MessageListener to notify about changed data, or NULL. */
+  static MessageListener* s_listener;
+
+  /** the sequence number of the last change of any @a Message (incremented from the bus and the main thread). */
+  static std::atomic<unsigned int> s_lastChangeSequence;
 };
 
 
@@ -1205,6 +1290,70 @@ class LoadedFileInfo {
 };
 
 
+/**
+ * A set of include and exclude patterns for selecting @a Message instances by circuit and name.
+ * Each pattern is an extended regular expression that is applied to "CIRCUIT:NAME" (case sensitive).
+ */
+class MessagePatterns {
+ public:
+  /**
+   * Construct a new empty instance.
+   */
+  MessagePatterns() {}
+
+  /**
+   * Destructor.
+   */
+  ~MessagePatterns();
+
+
+ private:
+  /**
+   * Hidden copy constructor.
+   * @param src the object to copy from.
+   */
+  MessagePatterns(const MessagePatterns& src);
+
+  /**
+   * Hidden assignment operator.
+   * @param src the object to copy from.
+   * @return this object.
+   */
+  MessagePatterns& operator=(const MessagePatterns& src);
+
+
+ public:
+  /**
+   * Compile and add a pattern.
+   * @param pattern the extended regular expression to add.
+   * @param exclude true to add an exclude pattern, false to add an include pattern.
+   * @return @a RESULT_OK on success, or an error code (e.g. for an invalid expression).
+   */
+  result_t add(const string& pattern, bool exclude = false);
+
+  /**
+   * @return true when no pattern was added.
+   */
+  bool empty() const { return m_includes.empty() && m_excludes.empty(); }
+
+  /**
+   * Check whether the subject is selected by the patterns.
+   * @param subject the "CIRCUIT:NAME" to check.
+   * @return true when no include pattern was added or at least one of them matches, and none of the exclude patterns
+   * matches.
+   */
+  bool matches(const char* subject) const;
+
+
+ private:
+  /** the compiled include patterns. */
+  vector<regex_t*> m_includes;
+
+  /** the compiled exclude patterns. */
+  vector<regex_t*> m_excludes;
+};
+
+
 /**
  * Holds a map of all known @a Message instances.
  */
@@ -1389,9 +1538,24 @@ class MessageMap : public MappedFileReader {
    * address), or 0 to ignore.
    * @param until the end time to which to add updates (exclusive, also removes messages with unset destination
    * address), or 0 to ignore.
+   * @param patterns the optional @a MessagePatterns for further selecting by circuit and name, or NULL.
    * Note: the caller may not free the returned instances.
    */
   deque<Message*> findAll(const string& circuit, const string& name, const string& levels,
+    const bool completeMatch = true, const bool withRead = true, const bool withWrite = false,
+    const bool withPassive = false, const bool includeEmptyLevel = true, const bool onlyAvailable = true,
+    const time_t since = 0, const time_t until = 0, const MessagePatterns* patterns = NULL) const;
+
+  /**
+   * Check whether the @a Message matches the criteria of @a findAll().
+   * @param message the @a Message to check.
+   * @param circuit the circuit name, or empty for any.
+   * @param name the message name, or empty for any.
+   * @param levels the access levels to match.
+   * @see findAll() for the remaining parameters.
+   * @return true when the @a Message matches.
+   */
+  bool matches(Message* message, const string& circuit, const string& name, const string& levels,
     const bool completeMatch = true, const bool withRead = true, const bool withWrite = false,
     const bool withPassive = false, const bool includeEmptyLevel = true, const bool onlyAvailable = true,
     const time_t since = 0, const time_t until = 0) const;
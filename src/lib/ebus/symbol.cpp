@@ -17,20 +17,12 @@
  */
 
 #include "lib/ebus/symbol.h"
-#include <iostream>
-#include <iomanip>
 #include <string>
 #include <vector>
 #include "lib/ebus/result.h"
 
 namespace ebusd {
 
-using std::ostringstream;
-using std::nouppercase;
-using std::setw;
-using std::hex;
-using std::setfill;
-
 /**
  * CRC8 lookup table for the polynom 0x9b = x^8 + x^7 + x^4 + x^3 + x^1 + 1.
  */
@@ -53,6 +45,100 @@ static const symbol_t CRC_LOOKUP_TABLE[] = {
   0x95, 0x0e, 0x38, 0xa3, 0x54, 0xcf, 0xf9, 0x62, 0x8c, 0x17, 0x21, 0xba, 0x4d, 0xd6, 0xe0, 0x7b,
 };
 
+/**
+ * CRC8 lookup table for applying @a CRC_LOOKUP_TABLE twice.
+ */
+static const symbol_t CRC_LOOKUP_TABLE2[] = {
+  0x00, 0x16, 0x2c, 0x3a, 0x58, 0x4e, 0x74, 0x62, 0xb0, 0xa6, 0x9c, 0x8a, 0xe8, 0xfe, 0xc4, 0xd2,
+  0xfb, 0xed, 0xd7, 0xc1, 0xa3, 0xb5, 0x8f, 0x99, 0x4b, 0x5d, 0x67, 0x71, 0x13, 0x05, 0x3f, 0x29,
+  0x6d, 0x7b, 0x41, 0x57, 0x35, 0x23, 0x19, 0x0f, 0xdd, 0xcb, 0xf1, 0xe7, 0x85, 0x93, 0xa9, 0xbf,
+  0x96, 0x80, 0xba, 0xac, 0xce, 0xd8, 0xe2, 0xf4, 0x26, 0x30, 0x0a, 0x1c, 0x7e, 0x68, 0x52, 0x44,
+  0xda, 0xcc, 0xf6, 0xe0, 0x82, 0x94, 0xae, 0xb8, 0x6a, 0x7c, 0x46, 0x50, 0x32, 0x24, 0x1e, 0x08,
+  0x21, 0x37, 0x0d, 0x1b, 0x79, 0x6f, 0x55, 0x43, 0x91, 0x87, 0xbd, 0xab, 0xc9, 0xdf, 0xe5, 0xf3,
+  0xb7, 0xa1, 0x9b, 0x8d, 0xef, 0xf9, 0xc3, 0xd5, 0x07, 0x11, 0x2b, 0x3d, 0x5f, 0x49, 0x73, 0x65,
+  0x4c, 0x5a, 0x60, 0x76, 0x14, 0x02, 0x38, 0x2e, 0xfc, 0xea, 0xd0, 0xc6, 0xa4, 0xb2, 0x88, 0x9e,
+  0x2f, 0x39, 0x03, 0x15, 0x77, 0x61, 0x5b, 0x4d, 0x9f, 0x89, 0xb3, 0xa5, 0xc7, 0xd1, 0xeb, 0xfd,
+  0xd4, 0xc2, 0xf8, 0xee, 0x8c, 0x9a, 0xa0, 0xb6, 0x64, 0x72, 0x48, 0x5e, 0x3c, 0x2a, 0x10, 0x06,
+  0x42, 0x54, 0x6e, 0x78, 0x1a, 0x0c, 0x36, 0x20, 0xf2, 0xe4, 0xde, 0xc8, 0xaa, 0xbc, 0x86, 0x90,
+  0xb9, 0xaf, 0x95, 0x83, 0xe1, 0xf7, 0xcd, 0xdb, 0x09, 0x1f, 0x25, 0x33, 0x51, 0x47, 0x7d, 0x6b,
+  0xf5, 0xe3, 0xd9, 0xcf, 0xad, 0xbb, 0x81, 0x97, 0x45, 0x53, 0x69, 0x7f, 0x1d, 0x0b, 0x31, 0x27,
+  0x0e, 0x18, 0x22, 0x34, 0x56, 0x40, 0x7a, 0x6c, 0xbe, 0xa8, 0x92, 0x84, 0xe6, 0xf0, 0xca, 0xdc,
+  0x98, 0x8e, 0xb4, 0xa2, 0xc0, 0xd6, 0xec, 0xfa, 0x28, 0x3e, 0x04, 0x12, 0x70, 0x66, 0x5c, 0x4a,
+  0x63, 0x75, 0x4f, 0x59, 0x3b, 0x2d, 0x17, 0x01, 0xd3, 0xc5, 0xff, 0xe9, 0x8b, 0x9d, 0xa7, 0xb1,
+};
+
+/**
+ * CRC8 lookup table for applying @a CRC_LOOKUP_TABLE three times.
+ */
+static const symbol_t CRC_LOOKUP_TABLE3[] = {
+  0x00, 0x5e, 0xbc, 0xe2, 0xe3, 0xbd, 0x5f, 0x01, 0x5d, 0x03, 0xe1, 0xbf, 0xbe, 0xe0, 0x02, 0x5c,
+  0xba, 0xe4, 0x06, 0x58, 0x59, 0x07, 0xe5, 0xbb, 0xe7, 0xb9, 0x5b, 0x05, 0x04, 0x5a, 0xb8, 0xe6,
+  0xef, 0xb1, 0x53, 0x0d, 0x0c, 0x52, 0xb0, 0xee, 0xb2, 0xec, 0x0e, 0x50, 0x51, 0x0f, 0xed, 0xb3,
+  0x55, 0x0b, 0xe9, 0xb7, 0xb6, 0xe8, 0x0a, 0x54, 0x08, 0x56, 0xb4, 0xea, 0xeb, 0xb5, 0x57, 0x09,
+  0x45, 0x1b, 0xf9, 0xa7, 0xa6, 0xf8, 0x1a, 0x44, 0x18, 0x46, 0xa4, 0xfa, 0xfb, 0xa5, 0x47, 0x19,
+  0xff, 0xa1, 0x43, 0x1d, 0x1c, 0x42, 0xa0, 0xfe, 0xa2, 0xfc, 0x1e, 0x40, 0x41, 0x1f, 0xfd, 0xa3,
+  0xaa, 0xf4, 0x16, 0x48, 0x49, 0x17, 0xf5, 0xab, 0xf7, 0xa9, 0x4b, 0x15, 0x14, 0x4a, 0xa8, 0xf6,
+  0x10, 0x4e, 0xac, 0xf2, 0xf3, 0xad, 0x4f, 0x11, 0x4d, 0x13, 0xf1, 0xaf, 0xae, 0xf0, 0x12, 0x4c,
+  0x8a, 0xd4, 0x36, 0x68, 0x69, 0x37, 0xd5, 0x8b, 0xd7, 0x89, 0x6b, 0x35, 0x34, 0x6a, 0x88, 0xd6,
+  0x30, 0x6e, 0x8c, 0xd2, 0xd3, 0x8d, 0x6f, 0x31, 0x6d, 0x33, 0xd1, 0x8f, 0x8e, 0xd0, 0x32, 0x6c,
+  0x65, 0x3b, 0xd9, 0x87, 0x86, 0xd8, 0x3a, 0x64, 0x38, 0x66, 0x84, 0xda, 0xdb, 0x85, 0x67, 0x39,
+  0xdf, 0x81, 0x63, 0x3d, 0x3c, 0x62, 0x80, 0xde, 0x82, 0xdc, 0x3e, 0x60, 0x61, 0x3f, 0xdd, 0x83,
+  0xcf, 0x91, 0x73, 0x2d, 0x2c, 0x72, 0x90, 0xce, 0x92, 0xcc, 0x2e, 0x70, 0x71, 0x2f, 0xcd, 0x93,
+  0x75, 0x2b, 0xc9, 0x97, 0x96, 0xc8, 0x2a, 0x74, 0x28, 0x76, 0x94, 0xca, 0xcb, 0x95, 0x77, 0x29,
+  0x20, 0x7e, 0x9c, 0xc2, 0xc3, 0x9d, 0x7f, 0x21, 0x7d, 0x23, 0xc1, 0x9f, 0x9e, 0xc0, 0x22, 0x7c,
+  0x9a, 0xc4, 0x26, 0x78, 0x79, 0x27, 0xc5, 0x9b, 0xc7, 0x99, 0x7b, 0x25, 0x24, 0x7a, 0x98, 0xc6,
+};
+
+/**
+ * CRC8 lookup table for applying @a CRC_LOOKUP_TABLE four times.
+ */
+static const symbol_t CRC_LOOKUP_TABLE4[] = {
+  0x00, 0x8f, 0x85, 0x0a, 0x91, 0x1e, 0x14, 0x9b, 0xb9, 0x36, 0x3c, 0xb3, 0x28, 0xa7, 0xad, 0x22,
+  0xe9, 0x66, 0x6c, 0xe3, 0x78, 0xf7, 0xfd, 0x72, 0x50, 0xdf, 0xd5, 0x5a, 0xc1, 0x4e, 0x44, 0xcb,
+  0x49, 0xc6, 0xcc, 0x43, 0xd8, 0x57, 0x5d, 0xd2, 0xf0, 0x7f, 0x75, 0xfa, 0x61, 0xee, 0xe4, 0x6b,
+  0xa0, 0x2f, 0x25, 0xaa, 0x31, 0xbe, 0xb4, 0x3b, 0x19, 0x96, 0x9c, 0x13, 0x88, 0x07, 0x0d, 0x82,
+  0x92, 0x1d, 0x17, 0x98, 0x03, 0x8c, 0x86, 0x09, 0x2b, 0xa4, 0xae, 0x21, 0xba, 0x35, 0x3f, 0xb0,
+  0x7b, 0xf4, 0xfe, 0x71, 0xea, 0x65, 0x6f, 0xe0, 0xc2, 0x4d, 0x47, 0xc8, 0x53, 0xdc, 0xd6, 0x59,
+  0xdb, 0x54, 0x5e, 0xd1, 0x4a, 0xc5, 0xcf, 0x40, 0x62, 0xed, 0xe7, 0x68, 0xf3, 0x7c, 0x76, 0xf9,
+  0x32, 0xbd, 0xb7, 0x38, 0xa3, 0x2c, 0x26, 0xa9, 0x8b, 0x04, 0x0e, 0x81, 0x1a, 0x95, 0x9f, 0x10,
+  0xbf, 0x30, 0x3a, 0xb5, 0x2e, 0xa1, 0xab, 0x24, 0x06, 0x89, 0x83, 0x0c, 0x97, 0x18, 0x12, 0x9d,
+  0x56, 0xd9, 0xd3, 0x5c, 0xc7, 0x48, 0x42, 0xcd, 0xef, 0x60, 0x6a, 0xe5, 0x7e, 0xf1, 0xfb, 0x74,
+  0xf6, 0x79, 0x73, 0xfc, 0x67, 0xe8, 0xe2, 0x6d, 0x4f, 0xc0, 0xca, 0x45, 0xde, 0x51, 0x5b, 0xd4,
+  0x1f, 0x90, 0x9a, 0x15, 0x8e, 0x01, 0x0b, 0x84, 0xa6, 0x29, 0x23, 0xac, 0x37, 0xb8, 0xb2, 0x3d,
+  0x2d, 0xa2, 0xa8, 0x27, 0xbc, 0x33, 0x39, 0xb6, 0x94, 0x1b, 0x11, 0x9e, 0x05, 0x8a, 0x80, 0x0f,
+  0xc4, 0x4b, 0x41, 0xce, 0x55, 0xda, 0xd0, 0x5f, 0x7d, 0xf2, 0xf8, 0x77, 0xec, 0x63, 0x69, 0xe6,
+  0x64, 0xeb, 0xe1, 0x6e, 0xf5, 0x7a, 0x70, 0xff, 0xdd, 0x52, 0x58, 0xd7, 0x4c, 0xc3, 0xc9, 0x46,
+  0x8d, 0x02, 0x08, 0x87, 0x1c, 0x93, 0x99, 0x16, 0x34, 0xbb, 0xb1, 0x3e, 0xa5, 0x2a, 0x20, 0xaf,
+};
+
+
+/**
+ * The lower case hex digits.
+ */
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * Lookup table for the value of a hex digit character (0xff for all other characters).
+ */
+static const symbol_t HEX_DIGIT_VALUES[] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
 
 unsigned int parseInt(const char* str, int base, const unsigned int minValue, const unsigned int maxValue,
     result_t& result, size_t* length) {
@@ -99,78 +185,134 @@ int parseSignedInt(const char* str, int base, const int minValue, const int maxV
 }
 
 
-void SymbolString::updateCrc(symbol_t& crc, const symbol_t value) {
-  crc = CRC_LOOKUP_TABLE[crc]^value;
+void formatHexDigits(const symbol_t* data, size_t count, char* buffer) {
+  for (size_t pos = 0; pos < count; pos++) {
+    symbol_t value = data[pos];
+    buffer[2*pos] = HEX_DIGITS[value >> 4];
+    buffer[2*pos+1] = HEX_DIGITS[value & 0x0f];
+  }
 }
 
-result_t SymbolString::parseHex(const string& str) {
-  result_t result;
-  for (size_t i = 0; i < str.size(); i += 2) {
-    symbol_t value = (symbol_t)parseInt(str.substr(i, 2).c_str(), 16, 0, 0xff, result);
-    if (result != RESULT_OK) {
-      return result;
+result_t parseHexDigits(const char* str, size_t length, symbol_t* data) {
+  size_t count = length/2;
+  symbol_t invalid = 0;
+  for (size_t pos = 0; pos < count; pos++) {
+    symbol_t high = HEX_DIGIT_VALUES[(symbol_t)str[2*pos]], low = HEX_DIGIT_VALUES[(symbol_t)str[2*pos+1]];
+    invalid |= high|low;  // only invalid characters set the upper bits
+    data[pos] = (symbol_t)((high << 4) | low);
+  }
+  if (length > 2*count) {
+    symbol_t low = HEX_DIGIT_VALUES[(symbol_t)str[2*count]];
+    invalid |= low;
+    data[count] = low;
+  }
+  return (invalid & 0xf0) ? RESULT_ERR_INVALID_NUM : RESULT_OK;
+}
+
+size_t escapeSymbols(const symbol_t* data, size_t count, symbol_t* buffer) {
+  size_t written = 0;
+  for (size_t pos = 0; pos < count; pos++) {
+    symbol_t value = data[pos];
+    if ((symbol_t)(value-ESC) > 1) {
+      buffer[written++] = value;
+    } else {
+      buffer[written++] = ESC;
+      buffer[written++] = (symbol_t)(value-ESC);
     }
-    m_data.push_back(value);
   }
-  return RESULT_OK;
+  return written;
 }
 
-result_t SymbolString::parseHexEscaped(const string& str) {
-  result_t result;
-  bool inEscape = false;
-  for (size_t i = 0; i < str.size(); i += 2) {
-    symbol_t value = (symbol_t)parseInt(str.substr(i, 2).c_str(), 16, 0, 0xff, result);
-    if (result != RESULT_OK) {
-      return result;
+result_t unescapeSymbols(const symbol_t* data, size_t count, symbol_t* buffer, size_t& written) {
+  written = 0;
+  for (size_t pos = 0; pos < count; pos++) {
+    symbol_t value = data[pos];
+    if ((symbol_t)(value-ESC) > 1) {
+      buffer[written++] = value;
+      continue;
     }
-    if (inEscape) {
-      if (value == 0x00) {
-        m_data.push_back(ESC);
-        inEscape = false;
-      } else if (value == 0x01) {
-        m_data.push_back(SYN);
-        inEscape = false;
-      } else {
-        return RESULT_ERR_ESC;  // invalid escape sequence
-      }
-    } else if (value == ESC) {
-      inEscape = true;
-    } else if (value == SYN) {
+    if (value == SYN || ++pos >= count || data[pos] > 0x01) {
       return RESULT_ERR_ESC;  // invalid escape sequence
-    } else {
-      m_data.push_back(value);
     }
+    buffer[written++] = (symbol_t)(ESC+data[pos]);
   }
-  return inEscape ? RESULT_ERR_ESC : RESULT_OK;
+  return RESULT_OK;
+}
+
+
+void SymbolString::updateCrc(symbol_t& crc, const symbol_t value) {
+  crc = CRC_LOOKUP_TABLE[crc]^value;
+}
+
+result_t SymbolString::parseHex(const string& str) {
+  size_t count = (str.size()+1)/2;
+  if (count > MAX_SYMBOLS-m_length) {
+    return RESULT_ERR_INVALID_ARG;  // too many symbols
+  }
+  result_t result = parseHexDigits(str.data(), str.size(), m_data+m_length);
+  if (result == RESULT_OK) {
+    m_length += count;
+  }
+  return result;
+}
+
+result_t SymbolString::parseHexEscaped(const string& str) {
+  symbol_t escaped[2*MAX_SYMBOLS];
+  size_t count = (str.size()+1)/2;
+  if (count > sizeof(escaped)) {
+    return RESULT_ERR_INVALID_ARG;  // too many symbols
+  }
+  result_t result = parseHexDigits(str.data(), str.size(), escaped);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  symbol_t unescaped[2*MAX_SYMBOLS];
+  result = unescapeSymbols(escaped, count, unescaped, count);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  if (count > MAX_SYMBOLS-m_length) {
+    return RESULT_ERR_INVALID_ARG;  // too many symbols
+  }
+  memcpy(m_data+m_length, unescaped, count);
+  m_length += count;
+  return RESULT_OK;
 }
 
 const string SymbolString::getStr(size_t skipFirstSymbols) const {
-  ostringstream sstr;
-  for (size_t i = 0; i < m_data.size(); i++) {
-    if (skipFirstSymbols > 0) {
-      skipFirstSymbols--;
+  if (skipFirstSymbols >= m_length) {
+    return "";
+  }
+  string str(2*(m_length-skipFirstSymbols), '0');
+  formatHexDigits(m_data+skipFirstSymbols, m_length-skipFirstSymbols, &str[0]);
+  return str;
+}
+
+void SymbolString::updateCrc(symbol_t& crc, const symbol_t* data, size_t count) {
+  symbol_t value = crc;
+  const symbol_t* end = data+count;
+  while (data < end) {
+    if (end-data >= 4 && (symbol_t)(data[0]-ESC) > 1 && (symbol_t)(data[1]-ESC) > 1
+        && (symbol_t)(data[2]-ESC) > 1 && (symbol_t)(data[3]-ESC) > 1) {
+      // none of the next four symbols needs to be escaped: combine them in a single step
+      value = CRC_LOOKUP_TABLE4[value]^CRC_LOOKUP_TABLE3[data[0]]^CRC_LOOKUP_TABLE2[data[1]]
+        ^CRC_LOOKUP_TABLE[data[2]]^data[3];
+      data += 4;
+      continue;
+    }
+    symbol_t symbol = *data++;
+    if (symbol == ESC || symbol == SYN) {
+      value = CRC_LOOKUP_TABLE2[value]^CRC_LOOKUP_TABLE[ESC]^(symbol_t)(symbol == ESC ? 0x00 : 0x01);
     } else {
-      sstr << nouppercase << setw(2) << hex
-          << setfill('0') << static_cast<unsigned>(m_data[i]);
+      value = CRC_LOOKUP_TABLE[value]^symbol;
     }
   }
-  return sstr.str();
+  crc = value;
 }
 
 symbol_t SymbolString::calcCrc() const {
   symbol_t crc = 0;
-  for (size_t i = 0; i < m_data.size(); i++) {
-    symbol_t value = m_data[i];
-    if (value == ESC) {
-      updateCrc(crc, ESC);
-      updateCrc(crc, 0x00);
-    } else if (value == SYN) {
-      updateCrc(crc, ESC);
-      updateCrc(crc, 0x01);
-    } else {
-      updateCrc(crc, value);
-    }
-  }
+  updateCrc(crc, m_data, m_length);
   return crc;
 }
 
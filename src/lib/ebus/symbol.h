@@ -112,8 +112,49 @@ unsigned int parseInt(const char* str, int base, const unsigned int minValue, co
 int parseSignedInt(const char* str, int base, const int minValue, const int maxValue, result_t& result,
     size_t* length = NULL);
 
+/**
+ * Format symbols as lower case hex digits.
+ * @param data the symbols to format.
+ * @param count the number of symbols in @a data.
+ * @param buffer the buffer to write the 2*@a count hex digits to (without terminating zero).
+ */
+void formatHexDigits(const symbol_t* data, size_t count, char* buffer);
+
+/**
+ * Parse hex digits into symbols.
+ * @param str the hex digits (a single trailing digit is taken as a symbol of its own).
+ * @param length the number of characters in @a str.
+ * @param data the buffer to write the (@a length+1)/2 symbols to.
+ * @return @a RESULT_OK on success, or an error code.
+ */
+result_t parseHexDigits(const char* str, size_t length, symbol_t* data);
+
+/**
+ * Escape symbols for the bus, i.e. replace each #ESC with #ESC 0x00 and each #SYN with #ESC 0x01.
+ * @param data the unescaped symbols.
+ * @param count the number of symbols in @a data.
+ * @param buffer the buffer for the escaped symbols (with room for at least 2*@a count symbols).
+ * @return the number of escaped symbols written to @a buffer.
+ */
+size_t escapeSymbols(const symbol_t* data, size_t count, symbol_t* buffer);
+
+/**
+ * Unescape symbols from the bus, i.e. replace each #ESC 0x00 with #ESC and each #ESC 0x01 with #SYN.
+ * @param data the escaped symbols.
+ * @param count the number of symbols in @a data.
+ * @param buffer the buffer for the unescaped symbols (with room for at least @a count symbols).
+ * @param written the variable in which to store the number of unescaped symbols written to @a buffer.
+ * @return @a RESULT_OK on success, or @a RESULT_ERR_ESC for an invalid escape sequence or an unescaped #SYN.
+ */
+result_t unescapeSymbols(const symbol_t* data, size_t count, symbol_t* buffer, size_t& written);
+
+/** the maximum number of symbols in a @a SymbolString (master header QQ ZZ PB SB NN plus 255 data bytes DD). */
+#define MAX_SYMBOLS (5+255)
+
 /**
  * A string of unescaped bus symbols.
+ * The symbols are kept in fixed inline storage of @a MAX_SYMBOLS, so that neither filling nor copying an instance
+ * involves the heap.
  */
 class SymbolString {
  protected:
@@ -121,7 +162,7 @@ class SymbolString {
    * Creates a new empty instance.
    * @param isMaster whether this instance if for the master part.
    */
-  explicit SymbolString(const bool isMaster = false) { m_isMaster = isMaster; }
+  explicit SymbolString(const bool isMaster = false) : m_length(0), m_isMaster(isMaster) {}
 
  public:
   /**
@@ -131,6 +172,15 @@ class SymbolString {
    */
   static void updateCrc(symbol_t& crc, const symbol_t value);
 
+  /**
+   * Update the CRC by adding all unescaped symbols of a buffer (i.e. each #ESC and #SYN symbol is added as the
+   * corresponding escape sequence).
+   * @param crc the current CRC to update.
+   * @param data the unescaped symbols to add to the current CRC.
+   * @param count the number of symbols in @a data.
+   */
+  static void updateCrc(symbol_t& crc, const symbol_t* data, size_t count);
+
   /**
    * Return whether this instance if for the master part.
    * @return whether this instance if for the master part.
@@ -159,24 +209,34 @@ class SymbolString {
   const string getStr(size_t skipFirstSymbols = 0) const;
 
   /**
-   * Return a reference to the symbol at the specified index.
-   * @param index the index of the symbol to return.
-   * @return the reference to the symbol at the specified index.
+   * Copy the symbols from the other instance.
+   * @param other the @a SymbolString to copy from.
+   * @return this instance.
    */
-  symbol_t& operator[](const size_t index) {
-    if (index >= m_data.size()) {
-      m_data.resize(index+1, 0);
+  SymbolString& operator=(const SymbolString& other) {
+    if (this != &other) {
+      m_length = other.m_length;
+      m_isMaster = other.m_isMaster;
+      memcpy(m_data, other.m_data, m_length);
     }
-    return m_data[index];
+    return *this;
   }
 
+  /**
+   * Return a reference to the symbol at the specified index.
+   * @param index the index of the symbol to return.
+   * @return the reference to the symbol at the specified index (beyond @a MAX_SYMBOLS a reference to a spare symbol).
+   */
+  symbol_t& operator[](const size_t index) { return at(index); }
+
   /**
    * Return whether this instance is equal to the other instance.
    * @param other the other instance.
    * @return true if this instance is equal to the other instance.
    */
   bool operator == (SymbolString& other) {
-    return m_isMaster == other.m_isMaster && m_data == other.m_data;
+    return m_isMaster == other.m_isMaster && m_length == other.m_length
+      && memcmp(m_data, other.m_data, m_length) == 0;
   }
 
   /**
@@ -185,7 +245,7 @@ class SymbolString {
    * @return true if this instance is different from the other instance.
    */
   bool operator != (SymbolString& other) {
-    return m_isMaster != other.m_isMaster || m_data != other.m_data;
+    return !(*this == other);
   }
 
   /**
@@ -196,35 +256,36 @@ class SymbolString {
    * 2 if both instances are a master part and the data only differs in the first byte (the master address).
    */
   int compareTo(SymbolString& other) {
-    if (m_data.size() != other.m_data.size() || m_isMaster != other.m_isMaster) {
+    if (m_length != other.m_length || m_isMaster != other.m_isMaster) {
       return 1;
     }
-    if (m_data == other.m_data) {
-      return 0;
+    if (m_length == 0 || (m_isMaster && m_length == 1)) {
+      return m_length == 0 || m_data[0] == other.m_data[0] ? 0 : 2;
     }
-    if (!m_isMaster) {
+    if (memcmp(m_data+1, other.m_data+1, m_length-1) != 0) {
       return 1;
     }
-    if (m_data.size() == 1) {
-      return 2;
-    }
-    if (equal(m_data.begin()+1, m_data.end(), other.m_data.begin()+1)) {
-      return 2;
+    if (m_data[0] == other.m_data[0]) {
+      return 0;
     }
-    return 1;
+    return m_isMaster ? 2 : 1;
   }
 
   /**
-   * Append a symbol to the end of the symbol string.
+   * Append a symbol to the end of the symbol string (ignored when @a MAX_SYMBOLS are already present).
    * @param value the symbol to append.
    */
-  void push_back(const symbol_t value) { m_data.push_back(value); }
+  void push_back(const symbol_t value) {
+    if (m_length < MAX_SYMBOLS) {
+      m_data[m_length++] = value;
+    }
+  }
 
   /**
    * Return the number of symbols in this symbol string.
    * @return the number of available symbols.
    */
-  size_t size() const { return m_data.size(); }
+  size_t size() const { return m_length; }
 
   /**
    * Adjust the header NN field to the number of data bytes DD.
@@ -232,12 +293,13 @@ class SymbolString {
    */
   bool adjustHeader() {
     size_t lengthOffset = (m_isMaster ? 4 : 0);
-    if (m_data.size() <= lengthOffset) {
-      m_data.resize(lengthOffset+1);
-    } else if (m_data.size() >= lengthOffset+255) {
+    if (m_length <= lengthOffset) {
+      at(lengthOffset) = 0;
+      m_length = lengthOffset+1;
+    } else if (m_length >= lengthOffset+255) {
       return false;
     }
-    m_data[lengthOffset] = (symbol_t)(m_data.size() - 1 - lengthOffset);
+    m_data[lengthOffset] = (symbol_t)(m_length - 1 - lengthOffset);
     return true;
   }
 
@@ -253,11 +315,11 @@ class SymbolString {
    */
   size_t getDataSize() const {
     size_t lengthOffset = (m_isMaster ? 4 : 0);
-    if (m_data.size() <= lengthOffset) {
+    if (m_length <= lengthOffset) {
       return 0;
     }
     size_t ret = m_data[lengthOffset];
-    return m_data.size() < lengthOffset + 1 + ret ? m_data.size() - lengthOffset - 1 : ret;
+    return m_length < lengthOffset + 1 + ret ? m_length - lengthOffset - 1 : ret;
   }
 
   /**
@@ -267,7 +329,7 @@ class SymbolString {
    */
   symbol_t dataAt(const size_t index) const {
     size_t offset = (m_isMaster ? 5 : 1) + index;
-    if (offset < m_data.size()) {
+    if (offset < m_length) {
       return m_data[offset];
     }
     return 0;
@@ -279,11 +341,7 @@ class SymbolString {
    * @return the reference to the data byte at the specified index.
    */
   symbol_t& dataAt(const size_t index) {
-    size_t offset = (m_isMaster ? 5 : 1) + index;
-    if (offset >= m_data.size()) {
-      m_data.resize(offset+1, 0);
-    }
-    return m_data[offset];
+    return at((m_isMaster ? 5 : 1) + index);
   }
 
   /**
@@ -292,10 +350,10 @@ class SymbolString {
    */
   bool isComplete() {
     size_t lengthOffset = (m_isMaster ? 4 : 0);
-    if (m_data.size() < lengthOffset + 1) {
+    if (m_length < lengthOffset + 1) {
       return false;
     }
-    return m_data.size() >= lengthOffset + 1 + m_data[lengthOffset];
+    return m_length >= lengthOffset + 1 + m_data[lengthOffset];
   }
 
   /**
@@ -307,7 +365,7 @@ class SymbolString {
   /**
    * Clear the symbols.
    */
-  void clear() { m_data.clear(); }
+  void clear() { m_length = 0; }
 
 
  private:
@@ -316,10 +374,31 @@ class SymbolString {
    * @param str the @a SymbolString to copy from.
    */
   SymbolString(const SymbolString& str)
-    : m_data(str.m_data), m_isMaster(str.m_isMaster) {}
+    : m_length(str.m_length), m_isMaster(str.m_isMaster) {
+    memcpy(m_data, str.m_data, m_length);
+  }
+
+  /**
+   * Return a reference to the symbol at the specified index and extend the symbols with zero up to it if necessary.
+   * @param index the index of the symbol to return.
+   * @return the reference to the symbol at the specified index (beyond @a MAX_SYMBOLS a reference to a spare symbol).
+   */
+  symbol_t& at(const size_t index) {
+    if (index >= MAX_SYMBOLS) {
+      return m_data[MAX_SYMBOLS];
+    }
+    if (index >= m_length) {
+      memset(m_data+m_length, 0, index+1-m_length);
+      m_length = index+1;
+    }
+    return m_data[index];
+  }
+
+  /** the string of unescaped symbols (plus one spare symbol for writes beyond the capacity). */
+  symbol_t m_data[MAX_SYMBOLS+1];
 
-  /** the string of unescaped symbols. */
-  vector<symbol_t> m_data;
+  /** the number of symbols in @a m_data. */
+  size_t m_length;
 
   /** whether this instance is for the master part. */
   bool m_isMaster;
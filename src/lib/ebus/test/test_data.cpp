@@ -154,6 +154,7 @@ int main() {
     {"x,,day",   "26.10.2014", "10fe070002d0a3", "00", ""},
     {"x,,day",   "01.01.2000", "10fe070002ac8e", "00", ""},
     {"x,,day",   "31.12.2078", "10fe07000262ff", "00", ""},
+    {"x,,day",   "13.09.1900", "10fe070002ff00", "00", ""},
     {"x,,day",   "-.-.-",      "10fe070002ffff", "00", ""},
     {"x,,day",   "",           "10fe0700020000", "00", "Rw"},
     {"x,,bti",   "21:04:58",   "10fe070003580421",   "00", ""},
@@ -196,6 +197,7 @@ int main() {
     {"x,,min", "00:00", "10fe0700020000", "00", ""},
     {"x,,min", "23:59", "10fe0700029f05", "00", ""},
     {"x,,min", "24:00", "10fe070002a005", "00", ""},
+    {"x,,min", "04:15", "10fe070002ff00", "00", ""},
     {"x,,min", "-:-",   "10fe070002ffff", "00", ""},
     {"x,,min", "",      "10fe070002bbbb", "00", "rw"},
     {"x,,min", "24:01", "10fe070002a105", "00", "rw"},
@@ -436,6 +438,10 @@ int main() {
     {"x,,ulg", "4294967294", "10feffff04feffffff", "00", ""},
     {"x,,ulg", "-",          "10feffff04ffffffff", "00", ""},
     {"x,,ulg,10", "3.8",      "10feffff0426000000", "00", ""},
+    {"x,,ulg,10", "1677721.6", "10feffff0401000001", "00", "W"},
+    {"x,,ulg,10", "1677722.0", "10feffff0403000001", "00", "W"},
+    {"x,,ulg,100", "167772.16", "10feffff0401000001", "00", "W"},
+    {"x,,slg,10", "-1677721.6", "10feffff04fffffffe", "00", "W"},
     {"x,,ulg,-10", "380",     "10feffff0426000000", "00", ""},
     {"x,,ulg,0x0FF0F00F   =  VRT 350 ;0x33CCCC33=VRT 360;0x3CC3C33C=SD 17;0x66999966=SD 37;0x69969669=VRT 360+", "VRT 350",         "10feffff040FF0F00F", "00", ""},
     {"x,,ulg,0x=test", "",   "10feffff040FF0F00F", "00", "c"},
@@ -479,6 +485,8 @@ int main() {
     {"x,,bi3:2,0=off;1=on,ja/nein,Wahrheitswert", "\n    \"x\": {\"value\": 1}", "10feffff0108", "00", "vnj"},
     {"x,,bi3:2,0=off;1=on,ja/nein,Wahrheitswert", "\n    \"x\": {\"value\": 1, \"unit\": \"ja/nein\", \"comment\": \"Wahrheitswert\"}", "10feffff0108", "00", "vvvnj"},
     {"x,,bi3:2,0=off;1=on,ja/nein,Wahrheitswert", "\n    \"0\": {\"name\": \"x\", \"value\": 1}", "10feffff0108", "00", "nj"},
+    {"x,,bi3:2,0=o\\ff;1=on,05,in\tfo", "\n    \"x\": {\"value\": \"o\\\\ff\", \"unit\": \"05\", \"comment\": \"in\\tfo\"}", "10feffff0100", "00", "vvvj"},
+    {"x,,bi3:2,0=off;1=on,-1.5e3,1.", "\n    \"x\": {\"value\": \"off\", \"unit\": -1.5e3, \"comment\": \"1.\"}", "10feffff0100", "00", "vvvj"},
     {"x,,uch,1=test;2=high;3=off;0x10=on", "on", "10feffff0110", "00", ""},
     {"x,s,uch", "3", "1050ffff00", "0103", ""},
     {"x,,d2b,,°C,Aussentemperatur", "x=18.004 °C [Aussentemperatur]", "10fe0700090112", "00", "vvv"},
@@ -0,0 +1,405 @@
+/*
+ * ebusd - daemon for communication with eBUS heating systems.
+ * Copyright (C) 2014-2017 John Baier <ebusd@ebusd.eu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "lib/ebus/datatype.h"
+
+using namespace ebusd;
+using std::cout;
+using std::endl;
+using std::dec;
+using std::fixed;
+using std::setfill;
+using std::setprecision;
+using std::setw;
+using std::vector;
+
+static bool error = false;
+
+/**
+ * Format a numeric value with stream manipulators the way it was done before the dedicated formatter existed.
+ * @param type the @a NumberDataType.
+ * @param input the @a SymbolString to read the binary value from.
+ * @param length the number of symbols to read.
+ * @param output the ostringstream to append the formatted value to.
+ * @param outputFormat the @a OutputFormat options to use.
+ * @return @a RESULT_OK on success, or an error code.
+ */
+static result_t formatNumberStream(const NumberDataType* type, const SymbolString& input, size_t length,
+    ostringstream& output, OutputFormat outputFormat) {
+  unsigned int value = 0;
+  result_t result = type->readRawValue(input, 0, length, value);
+  if (result != RESULT_OK) {
+    return result;
+  }
+  output << setw(0) << dec;
+  if (!type->hasFlag(REQ) && value == type->getReplacement()) {
+    if (outputFormat & OF_JSON) {
+      output << "null";
+    } else {
+      output << NULL_VALUE;
+    }
+    return RESULT_OK;
+  }
+  size_t bitCount = type->getBitCount();
+  bool negative = false;
+  if (type->hasFlag(SIG)) {
+    negative = (value & (1u << (bitCount - 1))) != 0;
+    if (negative ? value < type->getMinValue() : value > type->getMaxValue()) {
+      return RESULT_ERR_OUT_OF_RANGE;
+    }
+  } else if (value < type->getMinValue() || value > type->getMaxValue()) {
+    return RESULT_ERR_OUT_OF_RANGE;
+  }
+  int signedValue;
+  if (bitCount == 32) {
+    if (!negative) {
+      if (type->getDivisor() <= 1) {
+        output << static_cast<unsigned>(value);
+      } else {
+        output << setprecision(static_cast<int>(type->getPrecision()))
+               << fixed << (static_cast<float>(value) / static_cast<float>(type->getDivisor()));
+      }
+      return RESULT_OK;
+    }
+    signedValue = static_cast<int>(value);
+  } else if (negative) {
+    signedValue = static_cast<int>(value) - (1 << bitCount);
+  } else {
+    signedValue = static_cast<int>(value);
+  }
+  if (type->getDivisor() <= 1) {
+    if (type->hasFlag(FIX) && type->hasFlag(BCD)) {
+      if (outputFormat & OF_JSON) {
+        output << '"';
+        output << setw(static_cast<int>(length * 2)) << setfill('0');
+        output << static_cast<signed>(signedValue) << setw(0);
+        output << '"';
+        return RESULT_OK;
+      }
+      output << setw(static_cast<int>(length * 2)) << setfill('0');
+    }
+    output << static_cast<signed>(signedValue) << setw(0);
+  } else {
+    output << setprecision(static_cast<int>(type->getPrecision()))
+           << fixed << (static_cast<float>(signedValue) / static_cast<float>(type->getDivisor()));
+  }
+  return RESULT_OK;
+}
+
+/**
+ * Format a date/time value with stream manipulators the way it was done before the dedicated formatter existed.
+ * @param type the @a DateTimeDataType.
+ * @param input the @a SymbolString to read the binary value from.
+ * @param length the number of symbols to read.
+ * @param output the ostringstream to append the formatted value to.
+ * @param outputFormat the @a OutputFormat options to use.
+ * @return @a RESULT_OK on success, or an error code.
+ */
+static result_t formatDateTimeStream(const DateTimeDataType* type, const SymbolString& input, size_t length,
+    ostringstream& output, OutputFormat outputFormat) {
+  size_t start = 0, count = length;
+  int incr = 1;
+  symbol_t symbol, last = 0, hour = 0;
+  if (count == REMAIN_LEN && input.getDataSize() > 0) {
+    count = input.getDataSize();
+  } else if (count > input.getDataSize()) {
+    return RESULT_ERR_INVALID_POS;
+  }
+  if (type->hasFlag(REV)) {  // reverted binary representation (most significant byte first)
+    start = length - 1;
+    incr = -1;
+  }
+
+  if (outputFormat & OF_JSON) {
+    output << '"';
+  }
+  int dateTime = (type->hasDate()?2:0) | (type->hasTime()?1:0);
+  for (size_t index = start, i = 0; i < count; index += incr, i++) {
+    if (length == 4 && i == 2 && type->hasDate()) {
+      continue;  // skip weekday in between
+    }
+    symbol = input.dataAt(index);
+    if (type->hasFlag(BCD) && (type->hasFlag(REQ) || symbol != type->getReplacement())) {
+      if ((symbol & 0xf0) > 0x90 || (symbol & 0x0f) > 0x09) {
+        return RESULT_ERR_OUT_OF_RANGE;  // invalid BCD
+      }
+      symbol = (symbol_t)((symbol >> 4) * 10 + (symbol & 0x0f));
+    }
+    switch (dateTime) {
+    case 2:  // date only
+      if (!type->hasFlag(REQ) && symbol == type->getReplacement()) {
+        if (i + 1 != length) {
+          output << NULL_VALUE << ".";
+          break;
+        } else if (last == type->getReplacement()) {
+          if (length == 2) {  // number of days since 01.01.1900
+            output << NULL_VALUE << ".";
+          }
+          output << NULL_VALUE;
+          break;
+        }
+      }
+      if (length == 2) {  // number of days since 01.01.1900
+        if (i == 0) {
+          break;
+        }
+        int mjd = last + symbol*256 + 15020;  // 01.01.1900
+        int y = static_cast<int>((mjd-15078.2)/365.25);
+        int m = static_cast<int>((mjd-14956.1-static_cast<int>(y*365.25))/30.6001);
+        int d = mjd-14956-static_cast<int>(y*365.25)-static_cast<int>(m*30.6001);
+        m--;
+        if (m >= 13) {
+          y++;
+          m -= 12;
+        }
+        output << dec << setfill('0') << setw(2) << static_cast<unsigned>(d) << "."
+            << setw(2) << static_cast<unsigned>(m) << "." << static_cast<unsigned>(y + 1900);
+        break;
+      }
+      if (i + 1 == length) {
+        output << (2000 + symbol);
+      } else if (symbol < 1 || (i == 0 && symbol > 31) || (i == 1 && symbol > 12)) {
+        return RESULT_ERR_OUT_OF_RANGE;  // invalid date
+      } else {
+        output << setw(2) << dec << setfill('0') << static_cast<unsigned>(symbol) << ".";
+      }
+      break;
+
+    case 1:  // time only
+      if (!type->hasFlag(REQ) && symbol == type->getReplacement()) {
+        if (length == 1) {  // truncated time
+          output << NULL_VALUE << ":" << NULL_VALUE;
+          break;
+        }
+        if (i > 0) {
+          output << ":";
+        }
+        output << NULL_VALUE;
+        break;
+      }
+      if (type->hasFlag(SPE)) {  // minutes since midnight
+        if (i == 0) {
+          last = symbol;
+          continue;
+        }
+        int minutes = symbol*256 + last;
+        if (minutes > 24*60) {
+          return RESULT_ERR_OUT_OF_RANGE;  // invalid value
+        }
+        int hour = minutes / 60;
+        if (hour > 24) {
+          return RESULT_ERR_OUT_OF_RANGE;  // invalid hour
+        }
+        output << setw(2) << dec << setfill('0') << static_cast<unsigned>(hour);
+        symbol = (symbol_t)(minutes % 60);
+      } else if (length == 1) {  // truncated time
+        if (type->getBitCount() < 8) {
+          symbol = (symbol_t)(symbol & ((1 << type->getBitCount()) - 1));
+        }
+        if (i == 0) {
+          symbol = (symbol_t)(symbol/(60/type->getResolution()));  // convert to hours
+          index -= incr;  // repeat for minutes
+          count++;
+        } else {
+          symbol = (symbol_t)((symbol % (60/type->getResolution())) * type->getResolution());  // convert to minutes
+        }
+      }
+      if (i == 0) {
+        if (symbol > 24) {
+          return RESULT_ERR_OUT_OF_RANGE;  // invalid hour
+        }
+        hour = symbol;
+      } else if (symbol > 59 || (hour == 24 && symbol > 0)) {
+        return RESULT_ERR_OUT_OF_RANGE;  // invalid time
+      }
+      if (i > 0) {
+        output << ":";
+      }
+      output << setw(2) << dec << setfill('0') << static_cast<unsigned>(symbol);
+      break;
+    }
+    last = symbol;
+  }
+  if (outputFormat & OF_JSON) {
+    output << '"';
+  }
+  return RESULT_OK;
+}
+
+/**
+ * Format the value with stream manipulators the way it was done before the dedicated formatter existed.
+ * @param type the @a DataType.
+ * @param input the @a SymbolString to read the binary value from.
+ * @param length the number of symbols to read.
+ * @param output the ostringstream to append the formatted value to.
+ * @param outputFormat the @a OutputFormat options to use.
+ * @return @a RESULT_OK on success, or an error code.
+ */
+static result_t formatStream(const DataType* type, const SymbolString& input, size_t length,
+    ostringstream& output, OutputFormat outputFormat = 0) {
+  if (type->isNumeric()) {
+    return formatNumberStream(reinterpret_cast<const NumberDataType*>(type), input, length, output, outputFormat);
+  }
+  return formatDateTimeStream(reinterpret_cast<const DateTimeDataType*>(type), input, length, output,
+      outputFormat);
+}
+
+/**
+ * Check whether the output for a raw value intentionally differs from the previous stream formatting.
+ * @param type the @a DataType.
+ * @param raw the raw value.
+ * @return true if the previous formatting showed a replacement for a single byte of a DAY or MIN value.
+ */
+static bool isChangedOutput(const DataType* type, uint64_t raw) {
+  bool lowNull = (raw & 0xff) == 0xff, highNull = (raw >> 8) == 0xff;
+  if (type->getId() == "DAY") {
+    return lowNull && !highNull;
+  }
+  return type->getId() == "MIN" && lowNull != highNull;
+}
+
+/**
+ * Decode and format all (or a sample of all) raw values of a type with both implementations, verify the text and
+ * JSON output is identical, and print the throughput.
+ * @param id the type identifier.
+ * @param length the length of the type in bytes.
+ * @param divisor the divisor of the derived type to use, or 0 for the type itself.
+ */
+static void benchmark(const string& id, size_t length, int divisor = 0) {
+  const DataType* type = DataTypeList::getInstance()->get(id, length);
+  string name = id;
+  if (type != NULL && divisor != 0) {
+    const NumberDataType* derived = NULL;
+    if (!type->isNumeric()
+        || reinterpret_cast<const NumberDataType*>(type)->derive(divisor, 0, derived) != RESULT_OK) {
+      type = NULL;
+    } else {
+      type = derived;
+    }
+    name += "/" + std::to_string(divisor);
+  }
+  if (type == NULL) {
+    cout << name << ": type not found" << endl;
+    error = true;
+    return;
+  }
+  size_t bits = type->getBitCount() < 8 ? 8 : type->getBitCount();
+  uint64_t count = 1ULL << (bits > 16 ? 16 : bits);
+  uint64_t step = bits > 16 ? ((1ULL << bits) / count) | 1 : 1;
+  vector<uint64_t> raws;
+  for (uint64_t raw = 0, index = 0; index < count; raw += step, index++) {
+    raws.push_back(raw);
+  }
+  if (bits == 32) {
+    for (uint64_t raw = 1ULL << 24; raw < (1ULL << 24) + 16; raw++) {
+      raws.push_back(raw);  // values not exactly representable in single precision
+    }
+  }
+  count = raws.size();
+  vector<SlaveSymbolString> inputs(count);
+  ostringstream before, after;
+  size_t mismatches = 0, valid = 0;
+  for (size_t index = 0; index < count; index++) {
+    SlaveSymbolString& input = inputs[index];
+    uint64_t raw = raws[index];
+    input.push_back(static_cast<symbol_t>(length));  // length field
+    for (size_t pos = 0; pos < length; pos++) {
+      input.dataAt(pos) = static_cast<symbol_t>(raw >> (8 * pos));
+    }
+    for (OutputFormat outputFormat : {0, OF_JSON}) {
+      before.str("");
+      after.str("");
+      result_t beforeResult = formatStream(type, input, length, before, outputFormat);
+      result_t afterResult = type->readSymbols(input, 0, length, after, outputFormat);
+      if (isChangedOutput(type, raw)) {
+        continue;
+      }
+      if (beforeResult != afterResult || (beforeResult == RESULT_OK && before.str() != after.str())) {
+        if (mismatches++ < 5) {
+          cout << name << (outputFormat ? " JSON" : "") << ": mismatch for raw " << raw << ": >" << before.str()
+               << "< vs >" << after.str() << "<" << endl;
+        }
+        error = true;
+      } else if (beforeResult == RESULT_OK && outputFormat == 0) {
+        valid++;
+      }
+    }
+  }
+  size_t rounds = count < 0x10000 ? 0x10000 / count : 1;
+  double beforeTime = 0, afterTime = 0;
+  for (int trial = 0; trial < 3; trial++) {  // take the fastest of several runs to reduce noise
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      for (const auto& input : inputs) {
+        before.seekp(0);
+        formatStream(type, input, length, before);
+      }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      for (const auto& input : inputs) {
+        after.seekp(0);
+        type->readSymbols(input, 0, length, after, 0);
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double time = std::chrono::duration<double, std::nano>(middle - start).count();
+    beforeTime = trial == 0 || time < beforeTime ? time : beforeTime;
+    time = std::chrono::duration<double, std::nano>(end - middle).count();
+    afterTime = trial == 0 || time < afterTime ? time : afterTime;
+  }
+  double total = static_cast<double>(rounds * count);
+  cout << name << ":" << length << " " << count << " values (" << valid << " valid): stream " << setprecision(1)
+       << fixed << (beforeTime / total) << " ns/value, formatter " << (afterTime / total) << " ns/value"
+       << (mismatches ? " error" : " OK") << endl;
+}
+
+int main() {
+  benchmark("UCH", 1);
+  benchmark("SCH", 1);
+  benchmark("D1C", 1);
+  benchmark("BCD", 1);
+  benchmark("UIN", 2);
+  benchmark("SIN", 2);
+  benchmark("D2B", 2);
+  benchmark("D2C", 2);
+  benchmark("FLT", 2);
+  benchmark("FLR", 2);
+  benchmark("PIN", 2);
+  benchmark("S3N", 3);
+  benchmark("ULG", 4);
+  benchmark("SLG", 4);
+  benchmark("ULG", 4, 10);
+  benchmark("ULG", 4, 100);
+  benchmark("SLG", 4, 10);
+  benchmark("SLG", 4, 100);
+  benchmark("BDA", 4);
+  benchmark("HDA", 3);
+  benchmark("DAY", 2);
+  benchmark("BTI", 3);
+  benchmark("HTM", 2);
+  benchmark("MIN", 2);
+  benchmark("TTM", 1);
+
+  return error ? 1 : 0;
+}
@@ -408,6 +408,80 @@ int main() {
     }
   }
 
+  // selection by circuit/name and patterns (without the defaults from above)
+  messages->clear();
+  messages->getDefaults().clear();
+  string selectLines[] = {
+    "r,cir,TempInput,,,25,B509,0d2800,,,temp",
+    "r,cir,TempMax,,,25,B509,0d2900,,,temp",
+    "r,mc,TempInput,,,26,B509,0d2800,,,temp",
+  };
+  for (const auto& line : selectLines) {
+    istringstream isstr(line);
+    if (messages->readLineFromStream(isstr, errorDescription, __FILE__, lineNo, row) != RESULT_OK) {
+      cout << "\"" << line << "\": create error: " << errorDescription << endl;
+      error = true;
+    }
+  }
+  deque<Message*> found = messages->findAll("", "temp", "*", false);
+  cout << "findAll partial " << (found.size() == 3 ? "OK" : "error") << endl;
+  error |= found.size() != 3;
+  found = messages->findAll("CIR", "tempinput", "*", true);
+  cout << "findAll exact " << (found.size() == 1 ? "OK" : "error") << endl;
+  error |= found.size() != 1;
+  MessagePatterns patterns;
+  if (patterns.add("Temp(Input|Output)?$") != RESULT_OK || patterns.add("^mc:", true) != RESULT_OK
+      || patterns.add("(", true) == RESULT_OK) {
+    cout << "patterns add error" << endl;
+    error = true;
+  }
+  found = messages->findAll("", "", "*", false, true, false, false, true, false, 0, 0, &patterns);
+  if (found.size() == 1 && found.front()->getCircuit() == "cir" && found.front()->getName() == "TempInput") {
+    cout << "findAll patterns OK" << endl;
+    MasterSymbolString master;
+    SlaveSymbolString slave;
+    master.parseHex("ff25b509030d2800");
+    slave.parseHex("0220ff");
+    found.front()->storeLastData(master, slave);
+    ostringstream output;
+    vector<string> fields;
+    fields.push_back("nosuch");
+    result_t result = found.front()->decodeLastDataFields(output, 0, false, fields);
+    fields.push_back("temp.0");
+    result_t result2 = found.front()->decodeLastDataFields(output, 0, false, fields);
+    if (result == RESULT_EMPTY && result2 == RESULT_OK && output.str() == "-14.00") {
+      cout << "decode fields OK" << endl;
+    } else {
+      cout << "decode fields error: " << getResultCode(result) << ", " << getResultCode(result2) << ", got >"
+          << output.str() << "<" << endl;
+      error = true;
+    }
+    vector<DataValue> values;
+    vector<string> names;
+    result = found.front()->decodeLastDataValues(values, &names);
+    if (result == RESULT_OK && values.size() == 1 && values[0].getType() == vt_float
+        && values[0].getFloat() == -14.0 && names.size() == 1 && names[0] == "temp") {
+      cout << "decode values OK" << endl;
+    } else {
+      cout << "decode values error: " << getResultCode(result) << ", " << values.size() << endl;
+      error = true;
+    }
+    SlaveSymbolString replacementSlave;
+    replacementSlave.parseHex("020080");
+    found.front()->storeLastData(master, replacementSlave);
+    values.clear();
+    result = found.front()->decodeLastDataValues(values);
+    if (result == RESULT_OK && values.size() == 1 && values[0].isNull()) {
+      cout << "decode values replacement OK" << endl;
+    } else {
+      cout << "decode values replacement error: " << getResultCode(result) << ", " << values.size() << endl;
+      error = true;
+    }
+  } else {
+    cout << "findAll patterns error: " << found.size() << endl;
+    error = true;
+  }
+
   delete templates;
   delete messages;
   for (vector<MasterSymbolString*>::iterator it = mstrs.begin(); it != mstrs.end(); it++) {
@@ -0,0 +1,221 @@
+/*
+ * ebusd - daemon for communication with eBUS heating systems.
+ * Copyright (C) 2014-2017 John Baier <ebusd@ebusd.eu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lib/utils/queue.h"
+
+using namespace std;
+using namespace ebusd;
+
+static bool error = false;
+
+/** the number of producer threads for the concurrent test. */
+#define PRODUCERS 4
+
+/** the number of items pushed by each producer thread for the concurrent test. */
+#define ITEMS_PER_PRODUCER 20000
+
+/**
+ * An item for the @a LinkedQueue.
+ */
+class Item {
+  friend class LinkedQueue<Item>;
+
+ public:
+  /**
+   * Constructor.
+   * @param producer the index of the producing thread.
+   * @param value the value.
+   */
+  Item(int producer, int value) : m_producer(producer), m_value(value), m_queueNext(NULL) {}
+
+  /** the index of the producing thread. */
+  const int m_producer;
+
+  /** the value. */
+  const int m_value;
+
+
+ private:
+  /** the next @a Item in the @a LinkedQueue this instance is currently part of. */
+  Item* m_queueNext;
+};
+
+void verify(const string& type, bool match, const string& detail) {
+  if (match) {
+    cout << "  " << type << " OK" << endl;
+  } else {
+    cout << "  " << type << " error: " << detail << endl;
+    error = true;
+  }
+}
+
+/**
+ * Pop all items and return their values separated by comma.
+ * @param queue the @a LinkedQueue to pop from.
+ * @return the values separated by comma.
+ */
+static string popAll(LinkedQueue<Item>* queue) {
+  string result;
+  for (Item* item = queue->pop(); item; item = queue->pop()) {
+    if (!result.empty()) {
+      result += ",";
+    }
+    result += to_string(item->m_value);
+  }
+  return result;
+}
+
+/**
+ * Verify the order of items and the removal of items in a single thread.
+ */
+static void verifySingleThread() {
+  cout << "single thread:" << endl;
+  vector<Item*> items;
+  for (int i = 0; i <= 6; i++) {
+    items.push_back(new Item(0, i));
+  }
+  LinkedQueue<Item> queue;
+  verify("pop empty", queue.pop() == NULL && queue.peek() == NULL, "got an item");
+
+  for (int i = 1; i <= 5; i++) {
+    queue.push(items[i]);
+  }
+  string got = popAll(&queue);
+  verify("push order", got == "1,2,3,4,5", "got " + got);
+
+  // items pushed in between are appended after the ones already fetched
+  queue.push(items[1]);
+  queue.push(items[2]);
+  Item* item = queue.pop();
+  queue.push(items[3]);
+  got = to_string(item->m_value) + "," + popAll(&queue);
+  verify("push while popping", got == "1,2,3", "got " + got);
+
+  for (int i = 1; i <= 5; i++) {
+    queue.push(items[i]);
+  }
+  bool removed = queue.remove(items[3]);
+  verify("remove middle", removed, "not found");
+  removed = queue.remove(items[5]);
+  verify("remove tail", removed, "not found");
+  removed = queue.remove(items[1]);
+  verify("remove head", removed, "not found");
+  removed = queue.remove(items[3]);
+  verify("remove missing", !removed, "removed twice");
+  removed = queue.remove(items[0]);
+  verify("remove never pushed", !removed, "removed");
+  queue.push(items[6]);  // needs the tail to be updated on removal
+  got = popAll(&queue);
+  verify("order after remove", got == "2,4,6", "got " + got);
+
+  queue.push(items[1]);
+  queue.remove(items[1]);
+  queue.push(items[2]);
+  got = popAll(&queue);
+  verify("push after removing the only item", got == "2", "got " + got);
+
+  for (int i = 1; i <= 3; i++) {
+    queue.push(items[i]);
+  }
+  Item* first = queue.peek();
+  got.clear();
+  for (item = first; item; item = queue.peekNext(item)) {
+    got += to_string(item->m_value);
+  }
+  verify("peek and peekNext", first == items[1] && got == "123", "got " + got);
+  got = popAll(&queue);
+  verify("peek keeps items", got == "1,2,3", "got " + got);
+
+  for (auto it : items) {
+    delete it;
+  }
+}
+
+/**
+ * Verify the timed pop() waiting for an item being pushed by another thread.
+ */
+static void verifyTimedPop() {
+  cout << "timed pop:" << endl;
+  LinkedQueue<Item> queue;
+  Item item(0, 1);
+  auto start = chrono::steady_clock::now();
+  Item* got = queue.pop(1);
+  auto waited = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+  verify("timeout", got == NULL && waited >= 500 && waited < 2500, "waited " + to_string(waited) + " ms");
+
+  thread producer([&queue, &item]() {
+    this_thread::sleep_for(chrono::milliseconds(100));
+    queue.push(&item);
+  });
+  start = chrono::steady_clock::now();
+  got = queue.pop(5);
+  waited = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+  producer.join();
+  verify("wakeup on push", got == &item && waited < 2000, "waited " + to_string(waited) + " ms");
+}
+
+/**
+ * Verify pushing from several threads concurrently while popping in the consumer thread.
+ */
+static void verifyMultiProducer() {
+  cout << "multiple producers:" << endl;
+  LinkedQueue<Item> queue;
+  vector<thread> producers;
+  for (int p = 0; p < PRODUCERS; p++) {
+    producers.push_back(thread([&queue, p]() {
+      for (int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        queue.push(new Item(p, i));
+        if (i % 1000 == 0) {
+          this_thread::yield();
+        }
+      }
+    }));
+  }
+  int next[PRODUCERS] = {0};
+  int count = 0, outOfOrder = 0;
+  while (count < PRODUCERS * ITEMS_PER_PRODUCER) {
+    Item* item = queue.pop(5);
+    if (item == NULL) {
+      break;  // lost items
+    }
+    if (item->m_value != next[item->m_producer]) {
+      outOfOrder++;
+    }
+    next[item->m_producer] = item->m_value + 1;
+    count++;
+    delete item;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  verify("all items received", count == PRODUCERS * ITEMS_PER_PRODUCER && queue.pop() == NULL,
+      "got " + to_string(count));
+  verify("order per producer", outOfOrder == 0, to_string(outOfOrder) + " items out of order");
+}
+
+int main() {
+  verifySingleThread();
+  verifyTimedPop();
+  verifyMultiProducer();
+  return error ? 1 : 0;
+}
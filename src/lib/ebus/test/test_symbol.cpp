@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <string>
@@ -47,6 +48,147 @@ void verify(bool expectFailMatch, string type, string input,
   }
 }
 
+/**
+ * Calculate the CRC symbol by symbol the way it was done before the bulk calculation existed.
+ * @param str the @a SymbolString to calculate the CRC for.
+ * @return the calculated CRC.
+ */
+static symbol_t calcCrcBytewise(SymbolString& str) {
+  symbol_t crc = 0;
+  for (size_t i = 0; i < str.size(); i++) {
+    symbol_t value = str[i];
+    if (value == ESC) {
+      SymbolString::updateCrc(crc, ESC);
+      SymbolString::updateCrc(crc, 0x00);
+    } else if (value == SYN) {
+      SymbolString::updateCrc(crc, ESC);
+      SymbolString::updateCrc(crc, 0x01);
+    } else {
+      SymbolString::updateCrc(crc, value);
+    }
+  }
+  return crc;
+}
+
+/**
+ * Verify the bulk CRC calculation against the symbol by symbol calculation for pseudo random telegrams of all sizes
+ * and print the throughput of both.
+ */
+static void benchmarkCrc() {
+  vector<MasterSymbolString> inputs(MAX_SYMBOLS+1);
+  unsigned int seed = 1;
+  size_t mismatches = 0, total = 0;
+  for (size_t length = 0; length < inputs.size(); length++) {
+    for (size_t pos = 0; pos < length; pos++) {
+      seed = seed*1103515245+12345;
+      // make every 8th symbol on average one to escape
+      inputs[length].push_back((seed >> 16) % 8 == 0 ? static_cast<symbol_t>(ESC+((seed >> 8) & 1))
+          : static_cast<symbol_t>(seed >> 24));
+    }
+    total += length;
+    if (inputs[length].calcCrc() != calcCrcBytewise(inputs[length])) {
+      if (mismatches++ < 5) {
+        cout << "  CRC bulk mismatch for " << inputs[length].getStr() << endl;
+      }
+      error = true;
+    }
+  }
+  double beforeTime = 0, afterTime = 0;
+  symbol_t sum = 0;  // avoid the calculation being optimized away
+  for (int trial = 0; trial < 3; trial++) {  // take the fastest of several runs to reduce noise
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < 100; round++) {
+      for (auto& input : inputs) {
+        sum ^= calcCrcBytewise(input);
+      }
+    }
+    auto middle = chrono::steady_clock::now();
+    for (int round = 0; round < 100; round++) {
+      for (auto& input : inputs) {
+        sum ^= input.calcCrc();
+      }
+    }
+    auto end = chrono::steady_clock::now();
+    double time = chrono::duration<double, std::nano>(middle - start).count();
+    beforeTime = trial == 0 || time < beforeTime ? time : beforeTime;
+    time = chrono::duration<double, std::nano>(end - middle).count();
+    afterTime = trial == 0 || time < afterTime ? time : afterTime;
+  }
+  double symbols = static_cast<double>(total*100);
+  cout << "  CRC bulk " << total << " symbols (" << static_cast<unsigned>(sum) << "): bytewise " << setprecision(2)
+       << fixed << (beforeTime / symbols) << " ns/symbol, bulk " << (afterTime / symbols) << " ns/symbol"
+       << (mismatches ? " error" : " OK") << endl;
+}
+
+/**
+ * Format the symbols as hex string with stream manipulators the way it was done before the bulk formatter existed.
+ * @param str the @a SymbolString to format.
+ * @return the symbols as hex string.
+ */
+static string getStrStream(SymbolString& str) {
+  ostringstream sstr;
+  for (size_t i = 0; i < str.size(); i++) {
+    sstr << nouppercase << setw(2) << hex << setfill('0') << static_cast<unsigned>(str[i]);
+  }
+  return sstr.str();
+}
+
+/**
+ * Verify the bulk hex and escape routines against the symbol by symbol implementation for pseudo random telegrams.
+ */
+static void verifyBulk() {
+  unsigned int seed = 1;
+  size_t mismatches = 0;
+  for (size_t length = 0; length <= MAX_SYMBOLS; length++) {
+    SlaveSymbolString input;
+    symbol_t symbols[MAX_SYMBOLS];
+    for (size_t pos = 0; pos < length; pos++) {
+      seed = seed*1103515245+12345;
+      symbols[pos] = (seed >> 16) % 8 == 0 ? static_cast<symbol_t>(ESC+((seed >> 8) & 1))
+          : static_cast<symbol_t>(seed >> 24);
+      input.push_back(symbols[pos]);
+    }
+    string hexStr = getStrStream(input);
+    bool match = input.getStr() == hexStr;
+    SlaveSymbolString parsed;
+    match = match && parsed.parseHex(hexStr) == RESULT_OK && parsed == input;
+    symbol_t escaped[2*MAX_SYMBOLS];
+    size_t escapedLength = escapeSymbols(symbols, length, escaped), unescapedLength = 0;
+    string escapedStr;
+    for (size_t pos = 0; pos < length; pos++) {
+      if (symbols[pos] == ESC) {
+        escapedStr += "a900";
+      } else if (symbols[pos] == SYN) {
+        escapedStr += "a901";
+      } else {
+        escapedStr += hexStr.substr(2*pos, 2);
+      }
+    }
+    char escapedHex[4*MAX_SYMBOLS];
+    formatHexDigits(escaped, escapedLength, escapedHex);
+    match = match && string(escapedHex, 2*escapedLength) == escapedStr;
+    symbol_t unescaped[2*MAX_SYMBOLS];
+    match = match && unescapeSymbols(escaped, escapedLength, unescaped, unescapedLength) == RESULT_OK
+        && unescapedLength == length && memcmp(unescaped, symbols, length) == 0;
+    parsed.clear();
+    match = match && parsed.parseHexEscaped(escapedStr) == RESULT_OK && parsed == input;
+    if (!match) {
+      if (mismatches++ < 5) {
+        cout << "  bulk mismatch for " << hexStr << endl;
+      }
+      error = true;
+    }
+  }
+  cout << "  bulk hex and escape " << (mismatches ? "error" : "OK") << endl;
+  const char* invalid[] = {"0g", "x0", " 1", "+1", "a9aa", "a902", "aa", "a9"};
+  for (auto str : invalid) {
+    SlaveSymbolString parsed;
+    bool escapedOnly = str[0] == 'a';
+    result_t result = escapedOnly ? parsed.parseHexEscaped(str) : parsed.parseHex(str);
+    verify(true, escapedOnly ? "parse escaped" : "parse unescaped", str, result == RESULT_OK, "", "");
+  }
+}
+
 int main(int argc, char** argv) {
   MasterSymbolString mstr;
   if (argc > 1) {
@@ -119,6 +261,30 @@ int main(int argc, char** argv) {
     verify(false, "data size", "0427a90015a901", sstr.getDataSize() == 4, expectStr, gotStr);
   }
 
+  MasterSymbolString mcopy;
+  mcopy.parseHex("ff");
+  mcopy = mstr;
+  gotStr = mcopy.getStr(), expectStr = mstr.getStr();
+  verify(false, "copy", expectStr, mcopy == mstr && mcopy.compareTo(mstr) == 0, expectStr, gotStr);
+  mcopy[0] = 0x03;
+  verify(false, "compare", mcopy.getStr(), mcopy != mstr && mcopy.compareTo(mstr) == 2, "2",
+         to_string(mcopy.compareTo(mstr)));
+  mcopy.clear();
+  mcopy.dataAt(2) = 0x12;
+  verify(false, "extend", "dataAt(2)", mcopy.size() == 8, "0000000000000012", mcopy.getStr());
+  mcopy.clear();
+  result = mcopy.parseHex(string(2*MAX_SYMBOLS, 'a').substr(2) + "99");
+  if (result != RESULT_OK || mcopy.size() != MAX_SYMBOLS) {
+    cout << "parse maximum error: " << getResultCode(result) << endl;
+    error = true;
+  } else {
+    result = mcopy.parseHex("99");
+    verify(true, "parse beyond maximum", "99", result == RESULT_OK, "", "");
+  }
+
+  benchmarkCrc();
+  verifyBulk();
+
   int masterCnt = 0, slaveCnt = 0;
   for (int i=0; i<256; i++) {
     if (isMaster(i)) {
@@ -44,4 +44,27 @@ void clockGettime(struct timespec* t) {
 #endif
 }
 
+uint64_t clockGetMicros() {
+  struct timespec t;
+#ifdef __MACH__
+  clockGettime(&t);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &t);
+#endif
+  return static_cast<uint64_t>(t.tv_sec)*1000000 + static_cast<uint64_t>(t.tv_nsec)/1000;
+}
+
+uint64_t clockGetCpuMicros(pthread_t thread) {
+#ifdef __MACH__
+  return 0;
+#else
+  clockid_t clockId;
+  struct timespec t;
+  if (thread == 0 || pthread_getcpuclockid(thread, &clockId) != 0 || clock_gettime(clockId, &t) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(t.tv_sec)*1000000 + static_cast<uint64_t>(t.tv_nsec)/1000;
+#endif
+}
+
 }  // namespace ebusd
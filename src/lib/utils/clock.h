@@ -19,6 +19,8 @@
 #ifndef LIB_UTILS_CLOCK_H_
 #define LIB_UTILS_CLOCK_H_
 
+#include <pthread.h>
+#include <stdint.h>
 #include <time.h>
 
 namespace ebusd {
@@ -31,6 +33,19 @@ namespace ebusd {
  */
 void clockGettime(struct timespec* t);
 
+/**
+ * Get the current value of a monotonic clock for measuring durations.
+ * @return the monotonic time in microseconds (unrelated to the wall clock time).
+ */
+uint64_t clockGetMicros();
+
+/**
+ * Get the CPU time consumed by a thread.
+ * @param thread the thread to check.
+ * @return the consumed CPU time in microseconds, or 0 if not available on this platform.
+ */
+uint64_t clockGetCpuMicros(pthread_t thread);
+
 }  // namespace ebusd
 
 #endif  // LIB_UTILS_CLOCK_H_
@@ -42,6 +42,7 @@ class Notify {
       m_recvfd = pipefd[0];
       m_sendfd = pipefd[1];
 
+      fcntl(m_recvfd, F_SETFL, O_NONBLOCK);
       fcntl(m_sendfd, F_SETFL, O_NONBLOCK);
     }
   }
@@ -63,6 +64,16 @@ class Notify {
    */
   ssize_t notify() const { return write(m_sendfd, "1", 1); }
 
+  /**
+   * consume all pending notify events from the file descriptor.
+   */
+  void consume() const {
+    char buf[16];
+    while (read(m_recvfd, buf, sizeof(buf)) > 0) {
+      // continue until empty
+    }
+  }
+
  private:
   /** file descriptor to watch */
   int m_recvfd;
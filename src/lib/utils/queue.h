@@ -21,6 +21,7 @@
 
 #include <pthread.h>
 #include <errno.h>
+#include <atomic>
 #include <list>
 #include "lib/utils/clock.h"
 
@@ -154,6 +155,185 @@ class Queue {
   pthread_cond_t m_cond;
 };
 
+
+/**
+ * Lock-free template class for queuing items from several producer threads to a single consumer thread, where the
+ * items carry their own link to the next item.
+ * The item type has to provide a member "T* m_queueNext" (accessible to this class) that is exclusively used by the
+ * queue, so that an item can only be in a single @a LinkedQueue at a time and no memory is allocated for queuing.
+ * Producers push onto a stack with a single compare-and-swap. The consumer takes over the whole stack at once and
+ * keeps the items in order in its own list, so @a pop(), @a peek(), and @a remove() must only be called from the
+ * consumer thread. The mutex and condition variable are only used while the consumer waits in @a pop().
+ * @param T the item type.
+ */
+template <typename T>
+class LinkedQueue {
+ public:
+  /**
+   * Constructor.
+   */
+  LinkedQueue() : m_pushed(NULL), m_waiting(false), m_head(NULL), m_tail(NULL) {
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond, NULL);
+  }
+
+  /**
+   * Destructor.
+   */
+  ~LinkedQueue() {
+    pthread_mutex_destroy(&m_mutex);
+    pthread_cond_destroy(&m_cond);
+  }
+
+
+ private:
+  /**
+   * Hidden copy constructor.
+   * @param src the object to copy from.
+   */
+  LinkedQueue(const LinkedQueue& src);
+
+
+ public:
+  /**
+   * Add an item to the end of queue (callable from any thread).
+   * @param item the item to add.
+   */
+  void push(T* item) {
+    T* top = m_pushed.load(std::memory_order_relaxed);
+    do {
+      item->m_queueNext = top;
+    } while (!m_pushed.compare_exchange_weak(top, item));
+    if (m_waiting.load()) {
+      pthread_mutex_lock(&m_mutex);
+      pthread_cond_signal(&m_cond);
+      pthread_mutex_unlock(&m_mutex);
+    }
+  }
+
+  /**
+   * Remove the first item from the queue optionally waiting for the queue being non-empty (consumer thread only).
+   * @param timeout the maximum time in seconds to wait for the queue being filled, or 0 for no wait.
+   * @return the item, or NULL if no item is available within the specified time.
+   */
+  T* pop(int timeout = 0) {
+    if (!fetch() && timeout > 0) {
+      struct timespec t;
+      clockGettime(&t);
+      t.tv_sec += timeout;
+      pthread_mutex_lock(&m_mutex);
+      m_waiting.store(true);
+      while (!fetch()) {
+        if (pthread_cond_timedwait(&m_cond, &m_mutex, &t) == ETIMEDOUT) {
+          fetch();
+          break;
+        }
+      }
+      m_waiting.store(false);
+      pthread_mutex_unlock(&m_mutex);
+    }
+    T* item = m_head;
+    if (item) {
+      m_head = item->m_queueNext;
+      if (!m_head) {
+        m_tail = NULL;
+      }
+      item->m_queueNext = NULL;
+    }
+    return item;
+  }
+
+  /**
+   * Remove the specified item from the queue (consumer thread only).
+   * @param item the item to remove.
+   * @return whether the item was removed.
+   */
+  bool remove(T* item) {
+    fetch();
+    T* previous = NULL;
+    for (T* current = m_head; current; previous = current, current = current->m_queueNext) {
+      if (current != item) {
+        continue;
+      }
+      if (previous) {
+        previous->m_queueNext = item->m_queueNext;
+      } else {
+        m_head = item->m_queueNext;
+      }
+      if (m_tail == item) {
+        m_tail = previous;
+      }
+      item->m_queueNext = NULL;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Return the first item in the queue without removing it (consumer thread only).
+   * @return the item, or NULL if no item is available.
+   */
+  T* peek() {
+    fetch();
+    return m_head;
+  }
+
+  /**
+   * Return the item following the specified one in the queue without removing it (consumer thread only).
+   * @param item the item previously returned by @a peek() or this method.
+   * @return the following item, or NULL if no further item is available.
+   */
+  T* peekNext(T* item) {
+    return item->m_queueNext;
+  }
+
+
+ private:
+  /**
+   * Move the items pushed in the meantime to the end of the consumer list.
+   * @return whether the consumer list is non-empty.
+   */
+  bool fetch() {
+    if (m_pushed.load() == NULL) {
+      return m_head != NULL;
+    }
+    T* pushed = m_pushed.exchange(NULL);
+    T* first = NULL;
+    T* last = pushed;
+    while (pushed) {  // reverse to the order of pushing
+      T* next = pushed->m_queueNext;
+      pushed->m_queueNext = first;
+      first = pushed;
+      pushed = next;
+    }
+    if (m_tail) {
+      m_tail->m_queueNext = first;
+    } else {
+      m_head = first;
+    }
+    m_tail = last;
+    return true;
+  }
+
+  /** the stack of items pushed and not yet taken over by the consumer (latest first). */
+  std::atomic<T*> m_pushed;
+
+  /** whether the consumer is waiting for an item to be pushed. */
+  std::atomic<bool> m_waiting;
+
+  /** the first item in the consumer list, or NULL. */
+  T* m_head;
+
+  /** the last item in the consumer list, or NULL. */
+  T* m_tail;
+
+  /** mutex variable for waiting in the consumer */
+  pthread_mutex_t m_mutex;
+
+  /** condition variable for waiting in the consumer */
+  pthread_cond_t m_cond;
+};
+
 }  // namespace ebusd
 
 #endif  // LIB_UTILS_QUEUE_H_
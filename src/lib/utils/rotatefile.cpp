@@ -31,6 +31,9 @@ namespace ebusd {
 
 using std::streamsize;
 
+/** the lower case hex digits. */
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
 RotateFile::~RotateFile() {
   if (m_stream) {
     fclose(m_stream);
@@ -67,10 +70,20 @@ void RotateFile::write(unsigned char* value, unsigned int size, bool received) {
       td.tm_year+1900, td.tm_mon+1, td.tm_mday,
       td.tm_hour, td.tm_min, td.tm_sec, ts.tv_nsec/1000000,
       received ? '<' : '>');
-    for (unsigned int pos = 0; pos < size; pos++) {
-      fprintf(m_stream, "%2.2x ", value[pos]);
-    }
-    fprintf(m_stream, "\n");
+    char line[3*32+1];
+    unsigned int pos = 0;
+    do {
+      size_t length = 0;
+      for (; pos < size && length+3 < sizeof(line); pos++) {
+        line[length++] = HEX_DIGITS[value[pos] >> 4];
+        line[length++] = HEX_DIGITS[value[pos] & 0x0f];
+        line[length++] = ' ';
+      }
+      if (pos >= size) {
+        line[length++] = '\n';
+      }
+      fwrite(line, length, 1, m_stream);
+    } while (pos < size);
     m_fileSize += 25+3*size+1;
   } else {
     fwrite(value, (streamsize)size, 1, m_stream);
@@ -0,0 +1,97 @@
+/*
+ * ebusd - daemon for communication with eBUS heating systems.
+ * Copyright (C) 2014-2017 John Baier <ebusd@ebusd.eu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lib/utils/stats.h"
+#include <stdio.h>
+
+namespace ebusd {
+
+LatencyHistogram::LatencyHistogram() : m_count(0), m_sum(0), m_max(0) {
+  for (size_t index = 0; index < LATENCY_BUCKETS; index++) {
+    m_buckets[index] = 0;
+  }
+}
+
+void LatencyHistogram::add(uint64_t micros) {
+  // bucket N holds the durations up to 2^N microseconds
+  size_t index = 0;
+  for (uint64_t remain = micros > 0 ? micros - 1 : 0; remain > 0 && index < LATENCY_BUCKETS - 1; remain >>= 1) {
+    index++;
+  }
+  m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(micros, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  uint64_t max = m_max.load(std::memory_order_relaxed);
+  while (micros > max && !m_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    // retry with the updated max
+  }
+}
+
+uint64_t LatencyHistogram::getPercentile(unsigned int percent) const {
+  uint64_t count = getCount();
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t limit = (count * percent + 99) / 100, sum = 0;
+  uint64_t max = m_max.load(std::memory_order_relaxed);
+  for (size_t index = 0; index < LATENCY_BUCKETS - 1; index++) {
+    sum += m_buckets[index].load(std::memory_order_relaxed);
+    if (sum >= limit) {
+      return (1ULL << index) < max ? 1ULL << index : max;
+    }
+  }
+  return max;
+}
+
+void LatencyHistogram::formatSummary(ostream& output) const {
+  uint64_t count = getCount();
+  output << "count " << count;
+  if (count == 0) {
+    return;
+  }
+  output << ", avg " << getAverage() << " us"
+         << ", 50% <= " << getPercentile(50) << " us"
+         << ", 90% <= " << getPercentile(90) << " us"
+         << ", 99% <= " << getPercentile(99) << " us"
+         << ", max " << m_max.load(std::memory_order_relaxed) << " us";
+}
+
+void LatencyHistogram::formatMetrics(ostream& output, const string& name, const string& labels) const {
+  char str[32];
+  uint64_t sum = 0;
+  string prefix = labels.empty() ? "" : labels + ",";
+  for (size_t index = 0; index < LATENCY_BUCKETS - 1; index++) {
+    sum += m_buckets[index].load(std::memory_order_relaxed);
+    snprintf(str, sizeof(str), "%.6f", static_cast<double>(1ULL << index) / 1000000);
+    output << name << "_bucket{" << prefix << "le=\"" << str << "\"} " << sum << "\n";
+  }
+  uint64_t count = sum + m_buckets[LATENCY_BUCKETS - 1].load(std::memory_order_relaxed);
+  output << name << "_bucket{" << prefix << "le=\"+Inf\"} " << count << "\n";
+  snprintf(str, sizeof(str), "%.6f", static_cast<double>(m_sum.load(std::memory_order_relaxed)) / 1000000);
+  output << name << "_sum";
+  if (!labels.empty()) {
+    output << "{" << labels << "}";
+  }
+  output << " " << str << "\n" << name << "_count";
+  if (!labels.empty()) {
+    output << "{" << labels << "}";
+  }
+  output << " " << count << "\n";
+}
+
+}  // namespace ebusd
@@ -0,0 +1,116 @@
+/*
+ * ebusd - daemon for communication with eBUS heating systems.
+ * Copyright (C) 2014-2017 John Baier <ebusd@ebusd.eu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_UTILS_STATS_H_
+#define LIB_UTILS_STATS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include "lib/utils/clock.h"
+
+namespace ebusd {
+
+/** \file lib/utils/stats.h */
+
+using std::ostream;
+using std::string;
+
+/** the number of buckets in a @a LatencyHistogram (upper bounds 1us, 2us, 4us, ..., 2^25us=33.5s, and infinite). */
+#define LATENCY_BUCKETS 27
+
+/**
+ * A histogram of durations with fixed power of two buckets that may be updated from any thread without locking.
+ */
+class LatencyHistogram {
+ public:
+  /**
+   * Constructor.
+   */
+  LatencyHistogram();
+
+  /**
+   * Add a duration.
+   * @param micros the duration in microseconds.
+   */
+  void add(uint64_t micros);
+
+  /**
+   * Add the duration since the specified start time.
+   * @param start the start time as returned by @a clockGetMicros().
+   */
+  void addSince(uint64_t start) {
+    uint64_t now = clockGetMicros();
+    add(now > start ? now - start : 0);
+  }
+
+  /**
+   * Return the number of added durations.
+   * @return the number of added durations.
+   */
+  uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+
+  /**
+   * Return the average of the added durations.
+   * @return the average duration in microseconds, or 0 if nothing was added yet.
+   */
+  uint64_t getAverage() const {
+    uint64_t count = getCount();
+    return count == 0 ? 0 : m_sum.load(std::memory_order_relaxed) / count;
+  }
+
+  /**
+   * Return the upper bound of the bucket containing the specified percentile.
+   * @param percent the percentile (1 to 100).
+   * @return the upper bound of the bucket in microseconds (limited to the maximum added duration).
+   */
+  uint64_t getPercentile(unsigned int percent) const;
+
+  /**
+   * Format the summary of this histogram in a single line (without the trailing line feed).
+   * @param output the @a ostream to append to.
+   */
+  void formatSummary(ostream& output) const;
+
+  /**
+   * Format this histogram in Prometheus exposition format (without the help and type lines).
+   * @param output the @a ostream to append to.
+   * @param name the metric name (without the "_bucket", "_sum", or "_count" suffix).
+   * @param labels the already formatted additional labels separated by comma, or empty.
+   */
+  void formatMetrics(ostream& output, const string& name, const string& labels = "") const;
+
+
+ private:
+  /** the number of added durations. */
+  std::atomic<uint64_t> m_count;
+
+  /** the sum of all added durations in microseconds. */
+  std::atomic<uint64_t> m_sum;
+
+  /** the maximum added duration in microseconds. */
+  std::atomic<uint64_t> m_max;
+
+  /** the number of added durations by bucket. */
+  std::atomic<uint64_t> m_buckets[LATENCY_BUCKETS];
+};
+
+}  // namespace ebusd
+
+#endif  // LIB_UTILS_STATS_H_
@@ -215,7 +215,17 @@ string fetchData(ebusd::TCPSocket* socket, bool& listening) {
         break;
       }
     } else if (newInput) {
-      getline(cin, message);
+      if (!getline(cin, message)) {
+        // end of input reached: only wait for the answer
+#ifdef HAVE_PPOLL
+        fds[0].fd = -1;
+#else
+#ifdef HAVE_PSELECT
+        FD_CLR(STDIN_FILENO, &checkfds);
+#endif
+#endif
+        continue;
+      }
       sendmessage = message+'\n';
       socket->send(sendmessage.c_str(), sendmessage.size());
 